@@ -0,0 +1,183 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    // remembers every frame written to it
+    class RecordingSink : public FrameSink {
+    public:
+        void write(const Image& frame) override {
+            this->frames.push_back(frame.pixels);
+        }
+
+        void finish() override {
+            this->finished = true;
+        }
+
+        std::vector<std::vector<std::uint8_t>> frames;
+        bool finished = false;
+    };
+
+    // small enough frames for the tests to be quick
+    const Unit SCALE = 0.1;
+}
+
+TEST_CASE("Sweep follows the viewer's schedule", "[Animation]") {
+    Sweep sweep;
+
+    AnimationFrame first = sweep.next();
+    AnimationFrame second = sweep.next();
+
+    CHECK(first.angle == 0.1);
+    CHECK(first.p == 0.01);
+    CHECK(first.base_angle == 0);
+    CHECK(second.angle == Approx(0.2));
+    CHECK(second.base_angle == Approx(-0.075));
+
+    SECTION("turning around at the widest angle, and moving the branch point on") {
+        AnimationFrame frame = second;
+        AnimationFrame after = sweep.next();
+        while (after.angle > frame.angle) {
+            frame = after;
+            after = sweep.next();
+        }
+
+        CHECK(frame.angle == Approx(119.9).margin(0.15));
+        CHECK(after.p == Approx(0.02));
+    }
+}
+
+TEST_CASE("render_animation() writes every frame in order", "[Animation]") {
+    AnimationSettings settings = {};
+    settings.first_frame = 300;
+    settings.frames = 6;
+    settings.scale = SCALE;
+    settings.threads = 1;
+    RecordingSink sink;
+
+    render_animation(settings, sink);
+
+    CHECK(sink.finished);
+    REQUIRE(sink.frames.size() == 6);
+    Sweep sweep;
+    for (std::size_t f = 0; f < 300; f++) {
+        sweep.next();
+    }
+    for (const auto& frame : sink.frames) {
+        CHECK(frame == render_frame(sweep.next(), SCALE).pixels);
+    }
+
+    SECTION("however many threads render them") {
+        settings.threads = 4;
+        RecordingSink threaded;
+
+        render_animation(settings, threaded);
+
+        CHECK(threaded.frames == sink.frames);
+    }
+}
+
+TEST_CASE("render_animation() passes on anything its sink throws", "[Animation]") {
+    // gives up partway through
+    class FailingSink : public RecordingSink {
+    public:
+        void write(const Image& frame) override {
+            if (this->frames.size() == 2) {
+                throw std::runtime_error("disk full");
+            }
+            RecordingSink::write(frame);
+        }
+    };
+    AnimationSettings settings = {};
+    settings.frames = 20;
+    settings.scale = SCALE;
+    settings.threads = 3;
+    FailingSink sink;
+
+    CHECK_THROWS_AS(render_animation(settings, sink), std::runtime_error);
+    CHECK(sink.frames.size() == 2);
+    CHECK_FALSE(sink.finished);
+}
+
+TEST_CASE("build_many() builds the same Drawings as build_frame()", "[Animation]") {
+    Sweep sweep;
+    std::vector<AnimationFrame> frames;
+    for (std::size_t f = 0; f < 500; f++) {
+        AnimationFrame frame = sweep.next();
+        // a spread of frames, from across the sweep
+        if (f % 50 == 0) {
+            frames.push_back(frame);
+        }
+    }
+    auto threads = GENERATE(as<std::size_t>(), 1, 3);
+
+    std::vector<Drawing> drawings = build_many(frames, 10000, threads);
+
+    REQUIRE(drawings.size() == frames.size());
+    for (std::size_t f = 0; f < frames.size(); f++) {
+        CHECK(drawings[f].get_shapes().triangles == build_frame(frames[f]).get_shapes().triangles);
+    }
+}
+
+TEST_CASE("render_frame() draws the frame's triangles over a black background", "[Animation]") {
+    Image image = render_frame({60, 0.5, -45}, SCALE);
+
+    REQUIRE(image.width == 80);
+    REQUIRE(image.height == 60);
+    REQUIRE(image.pixels.size() == 80 * 60 * 3);
+    // the initial triangle is in the middle of the screen, and the corners are left empty
+    const std::uint8_t* middle = &image.pixels[(30 * 80 + 40) * 3];
+    CHECK(middle[0] + middle[1] + middle[2] > 0);
+    CHECK(image.pixels[0] + image.pixels[1] + image.pixels[2] == 0);
+}
+
+TEST_CASE("FrameSinks write video files", "[Animation]") {
+    Image frame = render_frame({60, 0.5, -45}, SCALE);
+
+    SECTION("Y4mSink") {
+        std::ostringstream stream;
+        Y4mSink sink(stream, 30);
+
+        sink.write(frame);
+        sink.write(frame);
+        sink.finish();
+
+        std::string header = "YUV4MPEG2 W80 H60 F30:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+        std::size_t frame_size = std::string("FRAME\n").size() + 80 * 60 + 2 * 40 * 30;
+        CHECK(stream.str().starts_with(header));
+        CHECK(stream.str().size() == header.size() + 2 * frame_size);
+    }
+
+    SECTION("PpmSequenceSink") {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / (
+            "triangberg-test-" + std::to_string(::getpid())
+        );
+        std::filesystem::create_directories(directory);
+        {
+            PpmSequenceSink sink(directory);
+            sink.write(frame);
+            sink.write(frame);
+        }
+
+        std::size_t size = std::string("P6\n80 60\n255\n").size() + 80 * 60 * 3;
+        CHECK(std::filesystem::file_size(directory / "frame_000000.ppm") == size);
+        CHECK(std::filesystem::file_size(directory / "frame_000001.ppm") == size);
+
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,533 @@
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/geometry.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    Drawing make_drawing() {
+        return {{400, 300}, 20, 0, 1, 0.01, 90, {800, 600}};
+    }
+
+    Drawing::Shapes build_one_at_a_time() {
+        Drawing drawing = make_drawing();
+        while (not drawing.is_complete()) {
+            drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
+        }
+        return drawing.get_shapes();
+    }
+
+    // three trees close enough together to get in each other's way
+    Drawing::Forest make_forest() {
+        return {
+            {
+                {{200, 300}, 20, 0, 1, 0.01, 90},
+                {{400, 300}, 20, 30, 2, 0.5, 60},
+                {{600, 300}, 20, 60, 0, 0.99, 120},
+            },
+            {800, 600},
+        };
+    }
+
+    // runs out of memory after allowing the given number of allocations
+    class FailingResource : public std::pmr::memory_resource {
+    public:
+        explicit FailingResource(std::size_t allowed)
+          : allocations(0)
+          , _allowed(allowed)
+          {}
+
+        std::size_t allocations;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            if (this->allocations == this->_allowed) {
+                throw std::bad_alloc();
+            }
+            this->allocations++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::size_t _allowed;
+    };
+}
+
+TEST_CASE("Drawing::add_triangles() stops at max_count", "[Drawing]") {
+    Drawing drawing = make_drawing();
+
+    Drawing::Growth growth = drawing.add_triangles(3);
+
+    CHECK(growth.added == 3);
+    CHECK_FALSE(growth.complete);
+    // 3 added on top of the initial triangle
+    CHECK(drawing.snapshot().size() == 4);
+}
+
+TEST_CASE("Drawing::add_triangles() builds the same as add_triangle()", "[Drawing]") {
+    Drawing::Shapes expected = build_one_at_a_time();
+    Drawing drawing = make_drawing();
+
+    Drawing::Growth growth = drawing.add_triangles(SIZE_MAX);
+
+    CHECK(growth.complete);
+    CHECK(drawing.is_complete());
+    CHECK(growth.added == expected.triangles.size() - 1);
+    CHECK(drawing.get_shapes().triangles == expected.triangles);
+}
+
+TEST_CASE("Drawing::grow_until() respects its deadline", "[Drawing]") {
+    SECTION("deadline already passed") {
+        Drawing drawing = make_drawing();
+
+        Drawing::Growth growth = drawing.grow_until(std::chrono::steady_clock::now());
+
+        CHECK(growth.added == 0);
+        CHECK_FALSE(growth.complete);
+    }
+
+    SECTION("deadline far away") {
+        Drawing::Shapes expected = build_one_at_a_time();
+        Drawing drawing = make_drawing();
+
+        Drawing::Growth growth = drawing.grow_until(
+            std::chrono::steady_clock::now() + std::chrono::hours(1)
+        );
+
+        CHECK(growth.complete);
+        CHECK(drawing.get_shapes().triangles == expected.triangles);
+    }
+}
+
+TEST_CASE("Drawing::set_scorer() picks the lowest-scoring candidate", "[Drawing]") {
+    // score candidates by how far their centre is from the top-left corner
+    auto distance_from_corner = [](const TriangleShape& t) {
+        Point centre = {(t[0].x + t[1].x + t[2].x) / 3, (t[0].y + t[1].y + t[2].y) / 3};
+        return (centre - Point{0, 0}).length();
+    };
+    Drawing scored = make_drawing();
+    scored.set_scorer(distance_from_corner);
+    // branched triangle is always the same
+    scored.add_triangles(1);
+
+    // a one-step beam search tries every candidate there is, so its best is the true lowest score
+    auto score_of_newest = [&](const Drawing& drawing) {
+        TriangleStore::Snapshot snapshot = drawing.snapshot();
+        return distance_from_corner(snapshot[snapshot.size() - 1]);
+    };
+    for (std::size_t step = 0; step < 8 and not scored.is_complete(); step++) {
+        std::vector<Drawing> every_next = Drawing::beam_search(scored, {SIZE_MAX, SIZE_MAX, 1, score_of_newest, 1});
+        REQUIRE_FALSE(every_next.empty());
+        std::size_t size = scored.snapshot().size();
+        bool can_grow = every_next.front().snapshot().size() > size;
+
+        scored.add_triangles(1);
+
+        REQUIRE(scored.snapshot().size() == size + (can_grow ? 1 : 0));
+        if (can_grow) {
+            CHECK(score_of_newest(scored) == score_of_newest(every_next.front()));
+        }
+    }
+    CHECK(scored.snapshot().size() > 3);
+
+    SECTION("scored drawings can still be grown to completion") {
+        Drawing::Growth growth = scored.add_triangles(SIZE_MAX);
+
+        CHECK(growth.complete);
+        // the scorer only changes the order triangles are tried in, not whether there are any
+        CHECK(scored.snapshot().size() > 3);
+    }
+}
+
+TEST_CASE("Drawing::set_edge_length_bounds() limits the size of new triangles", "[Drawing]") {
+    SECTION("generous bounds build the same as no bounds") {
+        Drawing::Shapes expected = build_one_at_a_time();
+        Drawing drawing = make_drawing();
+        drawing.set_edge_length_bounds(0, 1e6);
+
+        drawing.add_triangles(SIZE_MAX);
+
+        CHECK(drawing.get_shapes().triangles == expected.triangles);
+    }
+
+    SECTION("new triangles stay within the bounds") {
+        Unit min = 15;
+        Unit max = 19;
+        Drawing drawing = make_drawing();
+        drawing.set_edge_length_bounds(min, max);
+
+        drawing.add_triangles(SIZE_MAX);
+
+        auto snapshot = drawing.snapshot();
+        // the initial and branched triangles aren't bound by it
+        for (std::size_t i = 2; i < snapshot.size(); i++) {
+            TriangleShape t = snapshot[i];
+            Unit edge = (t[1] - t[0]).length();
+            CHECK(edge >= min);
+            CHECK(edge <= max);
+        }
+    }
+
+    SECTION("impossible bounds stop growth after the branched triangle") {
+        Drawing drawing = make_drawing();
+        drawing.set_edge_length_bounds(1e5, 1e6);
+
+        Drawing::Growth growth = drawing.add_triangles(SIZE_MAX);
+
+        CHECK(growth.complete);
+        CHECK(drawing.snapshot().size() == 2);
+    }
+
+    SECTION("changing the bounds of a scored drawing drops candidates ranked under the old ones") {
+        Drawing drawing = make_drawing();
+        drawing.set_scorer([](const TriangleShape& t) { return t[2].x; });
+        drawing.add_triangles(3);
+        std::size_t before = drawing.snapshot().size();
+
+        SECTION("edge length bounds") {
+            drawing.set_edge_length_bounds(1e5, 1e6);
+        }
+
+        SECTION("screen bounds") {
+            drawing.set_bounds({1e5, 1e5}, {10, 10});
+        }
+
+        Drawing::Growth growth = drawing.add_triangles(SIZE_MAX);
+
+        CHECK(growth.complete);
+        CHECK(growth.added == 0);
+        CHECK(drawing.snapshot().size() == before);
+    }
+}
+
+TEST_CASE("Drawing::get_stats() accounts for every pair tried", "[Drawing]") {
+    Drawing drawing = make_drawing();
+
+    Drawing::Growth growth = drawing.add_triangles(SIZE_MAX);
+
+    Drawing::Stats stats = drawing.get_stats();
+    // the branched triangle isn't made from a pair of vertices
+    CHECK(stats.candidates == growth.added - 1);
+    CHECK(
+        stats.pairs_tried ==
+            stats.rejected_ineligible + stats.rejected_shared + stats.rejected_size +
+            stats.rejected_off_screen + stats.rejected_covered + stats.rejected_intersecting +
+            stats.candidates
+    );
+    CHECK(stats.rejected_intersecting > 0);
+}
+
+TEST_CASE("Drawing::fork() grows separately from the Drawing it was forked from", "[Drawing]") {
+    Drawing::Shapes expected = build_one_at_a_time();
+    Drawing original = make_drawing();
+    original.add_triangles(5);
+
+    Drawing fork = original.fork();
+
+    CHECK(fork.get_shapes().triangles == original.get_shapes().triangles);
+
+    SECTION("forks grow the same as the original would have") {
+        fork.add_triangles(SIZE_MAX);
+
+        CHECK(fork.is_complete());
+        CHECK(fork.get_shapes().triangles == expected.triangles);
+    }
+
+    SECTION("growing a fork leaves the original as it was") {
+        auto before = original.get_shapes().triangles;
+
+        fork.add_triangles(SIZE_MAX);
+
+        CHECK(original.get_shapes().triangles == before);
+        CHECK_FALSE(original.is_complete());
+        // which can itself still be grown as normal
+        original.add_triangles(SIZE_MAX);
+        CHECK(original.get_shapes().triangles == expected.triangles);
+    }
+
+    SECTION("forks of scored drawings keep their ranked candidates") {
+        auto from_corner = [](const TriangleShape& t) { return (t[0] - Point{0, 0}).length(); };
+        Drawing scored = make_drawing();
+        scored.set_scorer(from_corner);
+        scored.add_triangles(5);
+        Drawing scored_fork = scored.fork();
+
+        scored_fork.add_triangles(SIZE_MAX);
+        scored.add_triangles(SIZE_MAX);
+
+        CHECK(scored_fork.get_shapes().triangles == scored.get_shapes().triangles);
+    }
+}
+
+TEST_CASE("Drawing::beam_search() keeps the best-scoring drawings", "[Drawing]") {
+    // prefer drawings which stay over to the left
+    auto leftness = [](const Drawing& drawing) {
+        Unit total = 0;
+        for (const TriangleShape& t : drawing.snapshot()) {
+            total += t[0].x + t[1].x + t[2].x;
+        }
+        return total;
+    };
+    Drawing start = make_drawing();
+    Drawing::BeamSearch search = {3, 4, 8, leftness, 1};
+
+    std::vector<Drawing> best = Drawing::beam_search(start, search);
+
+    REQUIRE(not best.empty());
+    CHECK(best.size() <= 3);
+    for (std::size_t i = 1; i < best.size(); i++) {
+        CHECK(leftness(best[i - 1]) <= leftness(best[i]));
+    }
+    // the start is forked, not grown
+    CHECK(start.snapshot().size() == 1);
+    CHECK(best.front().snapshot().size() > 1);
+
+    SECTION("the same drawings are found however many threads search") {
+        search.threads = 4;
+
+        std::vector<Drawing> threaded = Drawing::beam_search(start, search);
+
+        REQUIRE(threaded.size() == best.size());
+        for (std::size_t i = 0; i < best.size(); i++) {
+            CHECK(threaded[i].get_shapes().triangles == best[i].get_shapes().triangles);
+        }
+    }
+
+    SECTION("anything the score function throws is passed on, not left to end the program") {
+        search.threads = 4;
+        search.score = [](const Drawing&) -> Unit { throw std::runtime_error("can't score"); };
+
+        CHECK_THROWS_AS(Drawing::beam_search(start, search), std::runtime_error);
+    }
+}
+
+TEST_CASE("Drawing::get_coverage() grows with the drawing", "[Drawing]") {
+    Drawing drawing = make_drawing();
+    double initial = drawing.get_coverage();
+
+    drawing.add_triangles(SIZE_MAX);
+
+    // the initial triangle is about 0.1% of the screen
+    CHECK(initial > 0);
+    CHECK(initial < 0.01);
+    CHECK(drawing.get_coverage() > initial);
+    CHECK(drawing.get_coverage() <= 1);
+}
+
+TEST_CASE("Drawing::grow_until() can carry on from partway through a search", "[Drawing]") {
+    // so short that most searches are cut short
+    auto grow_in_slices = [](Drawing& drawing) {
+        std::size_t slices = 0;
+        while (not drawing.is_complete()) {
+            drawing.grow_until(std::chrono::steady_clock::now() + std::chrono::microseconds(1));
+            slices++;
+        }
+        return slices;
+    };
+
+    SECTION("trying every pair") {
+        Drawing::Shapes expected = build_one_at_a_time();
+        Drawing drawing = make_drawing();
+
+        std::size_t slices = grow_in_slices(drawing);
+
+        CHECK(slices > expected.triangles.size());
+        CHECK(drawing.get_shapes().triangles == expected.triangles);
+    }
+
+    SECTION("trying only nearby pairs") {
+        Drawing expected = make_drawing();
+        expected.set_edge_length_bounds(0, 1e6);
+        expected.add_triangles(SIZE_MAX);
+        Drawing drawing = make_drawing();
+        drawing.set_edge_length_bounds(0, 1e6);
+
+        grow_in_slices(drawing);
+
+        CHECK(drawing.get_shapes().triangles == expected.get_shapes().triangles);
+    }
+
+    SECTION("ranking every candidate") {
+        auto from_corner = [](const TriangleShape& t) { return (t[0] - Point{0, 0}).length(); };
+        Drawing expected = make_drawing();
+        expected.set_scorer(from_corner);
+        expected.add_triangles(SIZE_MAX);
+        Drawing drawing = make_drawing();
+        drawing.set_scorer(from_corner);
+
+        grow_in_slices(drawing);
+
+        CHECK(drawing.get_shapes().triangles == expected.get_shapes().triangles);
+    }
+}
+
+TEST_CASE("Drawing::grow_forest() grows trees that keep out of each other's way", "[Drawing]") {
+    Drawing::Forest forest = make_forest();
+    forest.threads = 1;
+
+    std::vector<Drawing> trees = Drawing::grow_forest(forest);
+
+    REQUIRE(trees.size() == forest.seeds.size());
+    bool any_held_back = false;
+    for (std::size_t t = 0; t < trees.size(); t++) {
+        const Drawing::Seed& seed = forest.seeds[t];
+        Drawing alone(
+            seed.origin, seed.size, seed.rotation, seed.branch_edge, seed.branch_point, seed.branch_angle,
+            forest.screen_size
+        );
+        alone.add_triangles(SIZE_MAX);
+        CHECK(trees[t].is_complete());
+        any_held_back = any_held_back or trees[t].get_shapes().triangles != alone.get_shapes().triangles;
+        for (std::size_t u = t + 1; u < trees.size(); u++) {
+            for (const TriangleShape& a : trees[t].snapshot()) {
+                for (const TriangleShape& b : trees[u].snapshot()) {
+                    CHECK_FALSE(are_intersecting(a, b));
+                }
+            }
+        }
+    }
+    // otherwise, this isn't testing much
+    CHECK(any_held_back);
+
+    SECTION("running out of memory at any point is passed on, not left to end the program") {
+        forest.max_triangles = 40;
+        FailingResource unlimited(SIZE_MAX);
+        Drawing::grow_forest(forest, &unlimited);
+        REQUIRE(unlimited.allocations > 0);
+        for (std::size_t allowed = 0; allowed < unlimited.allocations; allowed++) {
+            FailingResource resource(allowed);
+            CHECK_THROWS_AS(Drawing::grow_forest(forest, &resource), std::bad_alloc);
+        }
+    }
+
+    SECTION("a forest of one tree grows the same as a lone Drawing") {
+        forest.seeds = {{{400, 300}, 20, 0, 1, 0.01, 90}};
+        Drawing alone = make_drawing();
+        alone.add_triangles(SIZE_MAX);
+
+        std::vector<Drawing> lone_tree = Drawing::grow_forest(forest);
+
+        REQUIRE(lone_tree.size() == 1);
+        CHECK(lone_tree.front().get_shapes().triangles == alone.get_shapes().triangles);
+    }
+
+    SECTION("the same forest grows however many threads grow it") {
+        forest.threads = 3;
+
+        std::vector<Drawing> threaded = Drawing::grow_forest(forest);
+
+        REQUIRE(threaded.size() == trees.size());
+        for (std::size_t t = 0; t < trees.size(); t++) {
+            CHECK(threaded[t].get_shapes().triangles == trees[t].get_shapes().triangles);
+        }
+    }
+
+    SECTION("max_triangles limits the size of each tree") {
+        forest.max_triangles = 5;
+
+        std::vector<Drawing> small = Drawing::grow_forest(forest);
+
+        for (const Drawing& tree : small) {
+            CHECK(tree.snapshot().size() <= 5);
+        }
+    }
+}
+
+TEST_CASE("Drawing::build_async() builds on another thread until stopped", "[Drawing]") {
+    using namespace std::chrono_literals;
+    std::jthread worker;
+    auto executor = [&](std::function<void()> task) {
+        worker = std::jthread(std::move(task));
+    };
+
+    SECTION("run to completion, it builds the same as add_triangles()") {
+        Drawing expected = make_drawing();
+        expected.add_triangles(SIZE_MAX);
+        Drawing drawing = make_drawing();
+
+        Drawing::Growth growth = drawing.build_async(executor, {}).get();
+
+        CHECK(growth.complete);
+        CHECK(growth.added == expected.snapshot().size() - 1);
+        CHECK(drawing.get_shapes().triangles == expected.get_shapes().triangles);
+    }
+
+    SECTION("stopped, it can be carried on from where it stopped") {
+        // a grid of small triangles to fill in between, which takes a good while
+        std::vector<TriangleShape> seeds;
+        for (int y = 0; y < 5; y++) {
+            for (int x = 0; x < 5; x++) {
+                Point corner = {100.0 + x * 15, 100.0 + y * 15};
+                seeds.push_back({corner, corner + Vector{10, 0}, corner + Vector{0, 10}});
+            }
+        }
+        auto make_seeded = [&] {
+            Drawing drawing(seeds, {400, 400});
+            drawing.set_bounds({90, 90}, {85, 85});
+            drawing.set_edge_length_bounds(0, 20);
+            return drawing;
+        };
+        Drawing drawing = make_seeded();
+        std::stop_source stop;
+
+        std::future<Drawing::Growth> growth = drawing.build_async(executor, stop.get_token());
+        REQUIRE(growth.wait_for(10ms) == std::future_status::timeout);
+        auto stopped_at = std::chrono::steady_clock::now();
+        stop.request_stop();
+        // NOTE: far more than it should take, so as not to fail on a busy machine
+        REQUIRE(growth.wait_for(1s) == std::future_status::ready);
+        auto stopped_after = std::chrono::steady_clock::now() - stopped_at;
+        Drawing::Growth stopped = growth.get();
+
+        INFO("stopped after " << std::chrono::duration_cast<std::chrono::microseconds>(stopped_after).count() << "us");
+        CHECK_FALSE(stopped.complete);
+        CHECK_FALSE(drawing.is_complete());
+        drawing.add_triangles(SIZE_MAX);
+        Drawing expected = make_seeded();
+        expected.add_triangles(SIZE_MAX);
+        CHECK(drawing.get_shapes().triangles == expected.get_shapes().triangles);
+    }
+
+    SECTION("stopped before it starts, it adds nothing") {
+        Drawing drawing = make_drawing();
+        std::stop_source stop;
+        stop.request_stop();
+
+        Drawing::Growth growth = drawing.build_async(executor, stop.get_token()).get();
+
+        CHECK(growth.added == 0);
+        CHECK(drawing.snapshot().size() == 1);
+    }
+
+    SECTION("anything thrown whilst building comes out of the future") {
+        Drawing drawing = make_drawing();
+        drawing.set_scorer([](const TriangleShape&) -> Unit { throw std::runtime_error("can't score"); });
+
+        std::future<Drawing::Growth> growth = drawing.build_async(executor, {});
+
+        CHECK_THROWS_AS(growth.get(), std::runtime_error);
+    }
+}
@@ -0,0 +1,180 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/FrameRing.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    // a ring name no other test run will be using at the same time
+    std::string ring_name() {
+        return "/triangberg-test-" + std::to_string(::getpid());
+    }
+
+    const AnimationFrame FRAME = {90, 0.01, -67.5};
+}
+
+TEST_CASE("FrameRingReader reads back the frames written, in order", "[FrameRing]") {
+    Drawing drawing = build_frame(FRAME);
+    FrameRingWriter writer(ring_name(), 2);
+    REQUIRE(writer.is_open());
+    FrameRingReader reader(ring_name());
+    REQUIRE(reader.is_open());
+
+    CHECK(reader.available() == 0);
+    CHECK_FALSE(reader.peek());
+    REQUIRE(writer.write(FRAME, drawing));
+    REQUIRE(writer.write({1, 2, 3}, drawing));
+
+    CHECK(reader.available() == 2);
+    std::optional<RingFrame> frame = reader.peek();
+    REQUIRE(frame);
+    CHECK(frame->number == 0);
+    CHECK(frame->parameters.angle == FRAME.angle);
+    CHECK(frame->parameters.p == FRAME.p);
+    CHECK(frame->parameters.base_angle == FRAME.base_angle);
+    TriangleStore::Snapshot triangles = drawing.snapshot();
+    REQUIRE(frame->vertices.size() == triangles.size() * 3);
+    for (std::size_t t = 0; t < triangles.size(); t++) {
+        for (std::size_t c = 0; c < 3; c++) {
+            const FrameVertex& vertex = frame->vertices[t * 3 + c];
+            CHECK(vertex.x == (float)triangles[t][c].x);
+            CHECK(vertex.y == (float)triangles[t][c].y);
+            // shaded red, green, blue in turn
+            CHECK(vertex.red == (c == 0 ? 255 : 0));
+            CHECK(vertex.green == (c == 1 ? 255 : 0));
+            CHECK(vertex.blue == (c == 2 ? 255 : 0));
+        }
+    }
+    reader.pop();
+    frame = reader.peek();
+    REQUIRE(frame);
+    CHECK(frame->number == 1);
+    CHECK(frame->parameters.angle == 1);
+}
+
+TEST_CASE("FrameRingReader doesn't read past the end of a slot", "[FrameRing]") {
+    Drawing drawing = build_frame(FRAME);
+    REQUIRE(drawing.snapshot().size() > 8);
+    FrameRingWriter writer(ring_name(), 2, 8);
+    REQUIRE(writer.is_open());
+    FrameRingReader reader(ring_name());
+    REQUIRE(reader.is_open());
+    REQUIRE(writer.write(FRAME, drawing));
+    // stands in for a buggy writer, claiming far more triangles than the first slot can hold
+    int fd = ::shm_open(ring_name().c_str(), O_RDWR, 0);
+    REQUIRE(fd != -1);
+    void* memory = ::mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    REQUIRE(memory != MAP_FAILED);
+    // NOTE: the first slot starts after the 192-byte ring header, and its count follows four 8-byte fields
+    std::uint64_t& triangles = *(std::uint64_t*)((std::byte*)memory + 192 + 32);
+    REQUIRE(triangles == 8);
+    triangles = 1000000;
+
+    std::optional<RingFrame> frame = reader.peek();
+    REQUIRE(frame);
+    CHECK(frame->vertices.size() == 8 * 3);
+    ::munmap(memory, 4096);
+}
+
+TEST_CASE("FrameRingWriter doesn't write over frames that haven't been read", "[FrameRing]") {
+    Drawing drawing = build_frame(FRAME);
+    FrameRingWriter writer(ring_name(), 2);
+    REQUIRE(writer.is_open());
+    FrameRingReader reader(ring_name());
+    REQUIRE(reader.is_open());
+
+    CHECK(writer.write(FRAME, drawing));
+    CHECK(writer.write(FRAME, drawing));
+    CHECK(writer.is_full());
+    CHECK_FALSE(writer.write(FRAME, drawing));
+
+    reader.pop();
+
+    CHECK_FALSE(writer.is_full());
+    CHECK(writer.write(FRAME, drawing));
+    CHECK(reader.peek()->number == 1);
+}
+
+TEST_CASE("FrameRingReader can tell when the writer has gone", "[FrameRing]") {
+    CHECK_FALSE(FrameRingReader(ring_name()).is_open());
+
+    std::optional<FrameRingWriter> writer(std::in_place, ring_name());
+    REQUIRE(writer->is_open());
+    FrameRingReader reader(ring_name());
+    REQUIRE(reader.is_open());
+    REQUIRE(writer->write(FRAME, build_frame(FRAME)));
+    CHECK_FALSE(reader.is_closed());
+
+    writer.reset();
+
+    CHECK(reader.is_closed());
+    // what was already written can still be read
+    CHECK(reader.available() == 1);
+    REQUIRE(reader.peek());
+    CHECK_FALSE(FrameRingReader(ring_name()).is_open());
+}
+
+TEST_CASE("FrameRing hands frames over between processes", "[FrameRing]") {
+    const std::uint64_t FRAMES = 100;
+    Drawing drawing = build_frame(FRAME);
+    std::size_t vertices = drawing.snapshot().size() * 3;
+    // NOTE: the name is got before forking, as the child has a different process ID
+    std::string name = ring_name();
+    FrameRingWriter writer(name, 3);
+    REQUIRE(writer.is_open());
+
+    pid_t child = ::fork();
+    REQUIRE(child != -1);
+    if (child == 0) {
+        // the reader, which mustn't use the test framework, as it's in another process
+        FrameRingReader reader(name);
+        std::uint64_t expected = 0;
+        while (reader.is_open() and expected < FRAMES) {
+            std::optional<RingFrame> frame = reader.peek();
+            if (not frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (frame->number != expected or frame->vertices.size() != vertices) {
+                break;
+            }
+            reader.pop();
+            expected++;
+        }
+        ::_exit(expected == FRAMES ? 0 : 1);
+    }
+    int status;
+    bool exited = false;
+    for (std::uint64_t f = 0; f < FRAMES and not exited; f++) {
+        while (not writer.write(FRAME, drawing)) {
+            // don't wait forever for a reader that's given up
+            if (::waitpid(child, &status, WNOHANG) == child) {
+                exited = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    if (not exited) {
+        REQUIRE(::waitpid(child, &status, 0) == child);
+    }
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+}
@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/RenderService.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    RenderService::Request make_request(RenderService::Format format = RenderService::Format::GEOMETRY) {
+        return {{400, 300}, 20, 0, 1, 0.01, 90, {800, 600}, 10, format};
+    }
+
+    // a socket path no other test run will be using at the same time
+    std::string socket_path() {
+        return "/tmp/triangberg-test-" + std::to_string(::getpid()) + ".sock";
+    }
+}
+
+TEST_CASE("RenderService::Request survives encoding and decoding", "[RenderService]") {
+    RenderService::Request request = make_request(RenderService::Format::RASTER);
+
+    std::vector<std::uint8_t> bytes = request.encode();
+    std::optional<RenderService::Request> decoded = RenderService::Request::decode(bytes);
+
+    CHECK(bytes.size() == RenderService::Request::ENCODED_SIZE);
+    REQUIRE(decoded);
+    CHECK(decoded->encode() == bytes);
+
+    SECTION("garbage is rejected") {
+        bytes[0] ^= 0xff;
+
+        CHECK_FALSE(RenderService::Request::decode(bytes));
+    }
+}
+
+TEST_CASE("RenderService::Request rejects parameters that can't be drawn", "[RenderService]") {
+    RenderService::Request request = make_request();
+
+    SECTION("a branch edge a triangle doesn't have") {
+        request.branch_edge = 3;
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+    }
+
+    SECTION("a screen too big to rasterise") {
+        request.screen_size = {16385, 600};
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+    }
+
+    SECTION("numbers which aren't finite") {
+        request.origin.x = NAN;
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+
+        request.origin.x = 400;
+        request.branch_angle = INFINITY;
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+    }
+
+    SECTION("numbers far too big to be sensible") {
+        request.size = 1e300;
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+
+        request.size = 20;
+        request.rotation = -1e12;
+
+        CHECK_FALSE(RenderService::Request::decode(request.encode()));
+    }
+}
+
+TEST_CASE("RenderService serves the same geometry as building directly", "[RenderService]") {
+    RenderService::Request request = make_request();
+    Drawing drawing({400, 300}, 20, 0, 1, 0.01, 90, {800, 600});
+    drawing.add_triangles(request.max_triangles);
+    TriangleStore::Snapshot snapshot = drawing.snapshot();
+    std::vector<TriangleShape> expected(snapshot.begin(), snapshot.end());
+    RenderService service(socket_path(), 2);
+    REQUIRE(service.is_listening());
+
+    std::optional<std::vector<std::uint8_t>> payload = RenderService::fetch(socket_path(), request);
+
+    REQUIRE(payload);
+    std::optional<std::vector<TriangleShape>> triangles = RenderService::decode_geometry(*payload);
+    REQUIRE(triangles);
+    CHECK(*triangles == expected);
+}
+
+TEST_CASE("RenderService serves rasters the size of the screen", "[RenderService]") {
+    RenderService service(socket_path(), 2);
+    REQUIRE(service.is_listening());
+
+    std::optional<std::vector<std::uint8_t>> payload = RenderService::fetch(
+        socket_path(), make_request(RenderService::Format::RASTER)
+    );
+
+    REQUIRE(payload);
+    std::optional<RenderService::Raster> raster = RenderService::decode_raster(*payload);
+    REQUIRE(raster);
+    CHECK(raster->width == 800);
+    CHECK(raster->height == 600);
+    // the initial triangle is centred on the origin
+    CHECK(raster->pixels[300 * 800 + 400] == 255);
+    CHECK(raster->pixels[0] == 0);
+}
+
+TEST_CASE("RenderService only builds each drawing once", "[RenderService]") {
+    SECTION("repeated requests are answered from the cache") {
+        RenderService service(socket_path(), 2);
+        REQUIRE(service.is_listening());
+
+        std::optional<std::vector<std::uint8_t>> first = RenderService::fetch(socket_path(), make_request());
+        std::optional<std::vector<std::uint8_t>> second = RenderService::fetch(socket_path(), make_request());
+
+        REQUIRE(first);
+        CHECK(first == second);
+        CHECK(service.builds() == 1);
+    }
+
+    SECTION("concurrent identical requests share one build") {
+        RenderService service(socket_path(), 4);
+        REQUIRE(service.is_listening());
+        std::vector<std::optional<std::vector<std::uint8_t>>> payloads(8);
+
+        std::vector<std::thread> clients;
+        for (auto& payload : payloads) {
+            clients.emplace_back([&] { payload = RenderService::fetch(socket_path(), make_request()); });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+
+        for (const auto& payload : payloads) {
+            REQUIRE(payload);
+            CHECK(payload == payloads.front());
+        }
+        CHECK(service.builds() == 1);
+    }
+
+    SECTION("least recently used drawings are forgotten") {
+        RenderService service(socket_path(), 2, 1);
+        REQUIRE(service.is_listening());
+        RenderService::Request other = make_request();
+        other.rotation = 45;
+
+        RenderService::fetch(socket_path(), make_request());
+        RenderService::fetch(socket_path(), other);
+        RenderService::fetch(socket_path(), make_request());
+
+        CHECK(service.builds() == 3);
+    }
+
+    SECTION("drawings still being built aren't forgotten to make room for others") {
+        RenderService service(socket_path(), 4, 1);
+        REQUIRE(service.is_listening());
+        // big enough to still be building whilst the other is built and cached
+        RenderService::Request slow = make_request(RenderService::Format::RASTER);
+        slow.screen_size = {2000, 2000};
+        std::optional<std::vector<std::uint8_t>> first;
+
+        std::thread client([&] { first = RenderService::fetch(socket_path(), slow); });
+        while (service.builds() == 0) {
+            std::this_thread::yield();
+        }
+        std::optional<std::vector<std::uint8_t>> other = RenderService::fetch(socket_path(), make_request());
+        std::optional<std::vector<std::uint8_t>> second = RenderService::fetch(socket_path(), slow);
+        client.join();
+
+        REQUIRE(other);
+        REQUIRE(first);
+        CHECK(first == second);
+        // whether the slow one was still building when asked for again or had finished and been cached since
+        CHECK(service.builds() == 2);
+    }
+}
+
+TEST_CASE("RenderService isn't held up by idle connections", "[RenderService]") {
+    RenderService service(socket_path(), 1);
+    REQUIRE(service.is_listening());
+    // a client which connects, then never sends anything
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::string path = socket_path();
+    std::copy(path.begin(), path.end(), address.sun_path);
+    int idle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(::connect(idle, (const sockaddr*)&address, sizeof(address)) == 0);
+
+    CHECK(RenderService::fetch(socket_path(), make_request()));
+
+    ::close(idle);
+}
+
+TEST_CASE("RenderService::fetch() fails when nothing is listening", "[RenderService]") {
+    CHECK_FALSE(RenderService::fetch(socket_path(), make_request()));
+}
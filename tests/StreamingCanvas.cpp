@@ -0,0 +1,283 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/StreamingCanvas.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleSink.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    const Point ORIGIN = {400, 300};
+    const Vector TILE_SIZE = {200, 200};
+
+    // remembers everything streamed to it, checking along the way that each tile is only sent once
+    class RecordingSink : public TriangleSink {
+    public:
+        void write(const StreamedTile& tile) override {
+            CHECK(std::find(this->tiles.begin(), this->tiles.end(), tile.id) == this->tiles.end());
+            this->tiles.push_back(tile.id);
+            this->triangles.emplace_back(tile.triangles.begin(), tile.triangles.end());
+            // the tile's own triangles come first
+            REQUIRE(tile.surroundings.size() >= tile.triangles.size());
+            CHECK(std::equal(tile.triangles.begin(), tile.triangles.end(), tile.surroundings.begin()));
+        }
+
+        void finish() override {
+            this->finished = true;
+        }
+
+        // every streamed triangle, ordered by the tile it was grown in
+        std::vector<TriangleShape> in_growth_order() const {
+            std::vector<std::size_t> order(this->tiles.size());
+            for (std::size_t i = 0; i < order.size(); i++) {
+                order[i] = i;
+            }
+            auto growth_order = [](TiledCanvas::TileID id) {
+                return std::make_tuple(std::max(std::abs(id.x), std::abs(id.y)), id.x, id.y);
+            };
+            std::sort(
+                order.begin(), order.end(),
+                [&](std::size_t a, std::size_t b) { return growth_order(this->tiles[a]) < growth_order(this->tiles[b]); }
+            );
+            std::vector<TriangleShape> all;
+            for (std::size_t i : order) {
+                all.insert(all.end(), this->triangles[i].begin(), this->triangles[i].end());
+            }
+            return all;
+        }
+
+        std::vector<TiledCanvas::TileID> tiles;
+        std::vector<std::vector<TriangleShape>> triangles;
+        bool finished = false;
+    };
+
+    // a scratch directory no other test run will be using at the same time
+    std::filesystem::path scratch_directory() {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / (
+            "triangberg-test-" + std::to_string(::getpid())
+        );
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+}
+
+TEST_CASE("StreamingCanvas streams the same triangles as a TiledCanvas grows", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    TiledCanvas tiled(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 1);
+    // an area whose surrounding tiles are exactly those within 2 rings of the origin tile
+    Point top_left = ORIGIN - TILE_SIZE * 1.5 + Vector{1, 1};
+    Vector size = TILE_SIZE * 3 - Vector{2, 2};
+    tiled.wait(top_left, size);
+    RecordingSink sink;
+
+    SECTION("with every tile kept in memory") {
+        StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 2, sink, directory / "spill", 1000);
+        canvas.grow_all();
+
+        CHECK(canvas.tiles_grown() == 25);
+        CHECK(canvas.tiles_streamed() == 25);
+        CHECK(sink.finished);
+        CHECK(sink.in_growth_order() == tiled.get_triangles(top_left, size));
+    }
+
+    SECTION("with hardly any tiles kept in memory") {
+        StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 2, sink, directory / "spill", 2);
+        while (canvas.grow_next()) {
+            CHECK(canvas.resident_tiles() <= 2);
+        }
+
+        CHECK(canvas.tiles_streamed() == 25);
+        CHECK(sink.in_growth_order() == tiled.get_triangles(top_left, size));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("StreamingCanvas streams tiles out before it's finished growing", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    RecordingSink sink;
+    StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 3, sink, directory / "spill");
+
+    // the origin tile is done once its whole first ring is grown
+    for (std::size_t i = 0; i < 9; i++) {
+        canvas.grow_next();
+    }
+
+    CHECK(canvas.tiles_streamed() >= 1);
+    CHECK_FALSE(sink.finished);
+    REQUIRE_FALSE(sink.tiles.empty());
+    CHECK(sink.tiles.front() == TiledCanvas::TileID{0, 0});
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("StreamingCanvas stops if it can't use its spill file", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    RecordingSink sink;
+    StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 2, sink, directory / "missing" / "spill");
+
+    CHECK(canvas.has_failed());
+    CHECK_FALSE(canvas.grow_next());
+    CHECK(canvas.tiles_grown() == 0);
+    CHECK(sink.tiles.empty());
+    CHECK_FALSE(sink.finished);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("StreamingCanvas stops if its sink can't be written to", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    std::filesystem::path missing = directory / "missing";
+    // grows the drawing into the given sink, checking that it failed and said so
+    auto grow_into = [&](TriangleSink& sink) {
+        StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 1, sink, directory / "spill");
+        canvas.grow_all();
+
+        CHECK(sink.has_failed());
+        CHECK(canvas.has_failed());
+        CHECK_FALSE(canvas.grow_next());
+    };
+
+    SECTION("BinarySink to a directory that doesn't exist") {
+        BinarySink sink(missing / "drawing.bin");
+        grow_into(sink);
+    }
+
+    SECTION("SvgSink to a directory that doesn't exist") {
+        SvgSink sink(missing / "drawing.svg", ORIGIN - TILE_SIZE * 1.5, TILE_SIZE * 3);
+        grow_into(sink);
+    }
+
+    SECTION("RasterTileSink to a directory that doesn't exist") {
+        RasterTileSink sink(missing);
+        grow_into(sink);
+    }
+
+    SECTION("BinarySink to a full disk") {
+        // NOTE: every write to this fails as if the disk were full, on systems that have it
+        if (std::filesystem::exists("/dev/full")) {
+            BinarySink sink("/dev/full");
+            grow_into(sink);
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("TriangleSinks write every streamed tile", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    RecordingSink recording;
+    {
+        StreamingCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 1, recording, directory / "spill");
+        canvas.grow_all();
+    }
+    // replays what was recorded into another sink
+    auto replay = [&](TriangleSink& sink) {
+        for (std::size_t i = 0; i < recording.tiles.size(); i++) {
+            sink.write({recording.tiles[i], {}, TILE_SIZE, recording.triangles[i], recording.triangles[i]});
+        }
+        sink.finish();
+    };
+    std::vector<TriangleShape> all;
+    for (const auto& triangles : recording.triangles) {
+        all.insert(all.end(), triangles.begin(), triangles.end());
+    }
+
+    SECTION("BinarySink") {
+        {
+            BinarySink sink(directory / "drawing.bin");
+            replay(sink);
+        }
+
+        std::vector<TrianglePair> intersecting;
+        CHECK(BinarySink::read(directory / "drawing.bin", &intersecting) == all);
+        CHECK(intersecting.empty());
+    }
+
+    SECTION("SvgSink") {
+        {
+            SvgSink sink(directory / "drawing.svg", ORIGIN - TILE_SIZE * 1.5, TILE_SIZE * 3);
+            replay(sink);
+        }
+
+        std::ifstream file(directory / "drawing.svg");
+        std::string svg(std::istreambuf_iterator<char>(file), {});
+        std::size_t polygons = 0;
+        for (std::size_t at = svg.find("<polygon"); at != std::string::npos; at = svg.find("<polygon", at + 1)) {
+            polygons++;
+        }
+        CHECK(polygons == all.size());
+        CHECK(svg.ends_with("</svg>\n"));
+    }
+
+    SECTION("RasterTileSink") {
+        RasterTileSink sink(directory, 0.5);
+        replay(sink);
+
+        for (TiledCanvas::TileID id : recording.tiles) {
+            std::filesystem::path image = directory / (
+                "tile_" + std::to_string(id.x) + "_" + std::to_string(id.y) + ".pgm"
+            );
+            REQUIRE(std::filesystem::exists(image));
+            // header, then a byte for each of the 100x100 pixels
+            CHECK(std::filesystem::file_size(image) == std::string("P5\n100 100\n255\n").size() + 100 * 100);
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("BinarySink::read() stops before a truncated or corrupt tile", "[StreamingCanvas]") {
+    std::filesystem::path directory = scratch_directory();
+    std::filesystem::path path = directory / "drawing.bin";
+    std::vector<TriangleShape> first = {{Point{0, 0}, Point{10, 0}, Point{0, 10}}};
+    std::vector<TriangleShape> second = {
+        {Point{20, 0}, Point{30, 0}, Point{20, 10}},
+        {Point{40, 0}, Point{50, 0}, Point{40, 10}},
+    };
+    {
+        BinarySink sink(path);
+        sink.write({{0, 0}, {}, TILE_SIZE, first, first});
+        sink.write({{1, 0}, {}, TILE_SIZE, second, second});
+        sink.finish();
+    }
+    // a tile is two 64-bit coördinates and a 64-bit count, then six doubles per triangle
+    std::uintmax_t second_starts = 3 * 8 + 6 * 8;
+
+    SECTION("cut short partway through a triangle") {
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+        CHECK(BinarySink::read(path) == first);
+    }
+
+    SECTION("with a triangle count far bigger than the file") {
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp((std::streamoff)second_starts + 16);
+            std::uint64_t count = UINT64_MAX / 2;
+            file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+
+        CHECK(BinarySink::read(path) == first);
+    }
+
+    SECTION("that doesn't exist") {
+        CHECK(BinarySink::read(directory / "missing.bin").empty());
+    }
+
+    std::filesystem::remove_all(directory);
+}
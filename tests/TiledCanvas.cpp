@@ -0,0 +1,71 @@
+#include <cstddef>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/geometry.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    const Point ORIGIN = {400, 300};
+    const Vector TILE_SIZE = {200, 200};
+
+    std::vector<TriangleShape> grow_area(std::size_t threads, Point top_left, Vector size) {
+        TiledCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, threads);
+        canvas.wait(top_left, size);
+        return canvas.get_triangles(top_left, size);
+    }
+}
+
+TEST_CASE("TiledCanvas origin tile grows like a Drawing confined to it", "[TiledCanvas]") {
+    TiledCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 1);
+    Drawing drawing(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE);
+    drawing.set_bounds(ORIGIN - TILE_SIZE * 0.5, TILE_SIZE);
+    // no edge longer than half a tile
+    drawing.set_edge_length_bounds(0, 100);
+    drawing.add_triangles(SIZE_MAX);
+    std::vector<TriangleShape> expected(drawing.snapshot().begin(), drawing.snapshot().end());
+
+    // a tiny area in the middle of the origin tile
+    canvas.wait(ORIGIN, {1, 1});
+    std::vector<TriangleShape> triangles = canvas.get_triangles(ORIGIN, {1, 1});
+
+    // the origin tile's triangles come first, being the first in growth order
+    REQUIRE(triangles.size() >= expected.size());
+    CHECK(std::vector<TriangleShape>(triangles.begin(), triangles.begin() + (std::ptrdiff_t)expected.size()) == expected);
+}
+
+TEST_CASE("TiledCanvas growth doesn't depend on the number of threads", "[TiledCanvas]") {
+    Point top_left = {0, 0};
+    Vector size = {800, 600};
+
+    CHECK(grow_area(1, top_left, size) == grow_area(4, top_left, size));
+}
+
+TEST_CASE("TiledCanvas tiles never overlap each other's triangles", "[TiledCanvas]") {
+    // an area whose surrounding tiles are exactly those within 2 rings of the origin tile
+    Point top_left = ORIGIN - TILE_SIZE * 1.5 + Vector{1, 1};
+    Vector size = TILE_SIZE * 3 - Vector{2, 2};
+    std::vector<TriangleShape> triangles = grow_area(1, top_left, size);
+
+    REQUIRE_FALSE(triangles.empty());
+    CHECK(find_intersecting_triangles(triangles).empty());
+}
+
+TEST_CASE("TiledCanvas only grows the tiles it needs", "[TiledCanvas]") {
+    TiledCanvas canvas(ORIGIN, 20, 0, 1, 0.01, 90, TILE_SIZE, 2);
+    CHECK(canvas.tiles_grown() == 0);
+
+    canvas.wait(ORIGIN, {1, 1});
+
+    // the origin tile and its immediate neighbours
+    CHECK(canvas.tiles_grown() == 9);
+    CHECK(canvas.is_ready(ORIGIN, {1, 1}));
+    CHECK_FALSE(canvas.is_ready(ORIGIN + Vector{1000, 0}, {1, 1}));
+}
@@ -0,0 +1,161 @@
+#include <cstddef>
+
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    // a triangle whose coördinates encode its index, so readers can verify it
+    TriangleShape numbered_triangle(std::size_t i) {
+        Unit n = (Unit)i;
+        return {{{n, 0}, {n, 1}, {n, 2}}};
+    }
+}
+
+TEST_CASE("TriangleStore keeps triangles in order across chunk boundaries", "[TriangleStore]") {
+    TriangleStore store;
+    const std::size_t count = 5000;
+    for (std::size_t i = 0; i < count; i++) {
+        store.push_back(numbered_triangle(i));
+    }
+
+    TriangleStore::Snapshot snapshot = store.snapshot();
+    REQUIRE(snapshot.size() == count);
+    std::size_t i = 0;
+    for (const TriangleShape& triangle : snapshot) {
+        REQUIRE(triangle == numbered_triangle(i));
+        i++;
+    }
+    CHECK(i == count);
+}
+
+TEST_CASE("TriangleStore snapshot doesn't see later triangles", "[TriangleStore]") {
+    TriangleStore store;
+    store.push_back(numbered_triangle(0));
+    TriangleStore::Snapshot snapshot = store.snapshot();
+    store.push_back(numbered_triangle(1));
+
+    CHECK(snapshot.size() == 1);
+    CHECK(store.size() == 2);
+}
+
+TEST_CASE("TriangleStore snapshot can be narrowed to the triangles from some point on", "[TriangleStore]") {
+    TriangleStore store;
+    const std::size_t count = 200; // across a chunk boundary
+    for (std::size_t i = 0; i < count; i++) {
+        store.push_back(numbered_triangle(i));
+    }
+    TriangleStore::Snapshot snapshot = store.snapshot();
+
+    TriangleStore::Snapshot later = snapshot.since(50);
+
+    REQUIRE(later.size() == count - 50);
+    std::size_t i = 50;
+    for (const TriangleShape& triangle : later) {
+        REQUIRE(triangle == numbered_triangle(i));
+        i++;
+    }
+    CHECK(i == count);
+    CHECK(later[0] == numbered_triangle(50));
+    CHECK(later.since(100)[0] == numbered_triangle(150));
+    CHECK(snapshot.since(count).empty());
+    CHECK(snapshot.since(count + 1).empty());
+}
+
+TEST_CASE("TriangleStore can share another store's triangles", "[TriangleStore]") {
+    const std::size_t shared = 1000; // part-way through a chunk
+    auto base = std::make_unique<TriangleStore>();
+    for (std::size_t i = 0; i < shared; i++) {
+        base->push_back(numbered_triangle(i));
+    }
+
+    TriangleStore store(*base, std::pmr::get_default_resource());
+    // both carry on differently from where they were
+    for (std::size_t i = shared; i < 2 * shared; i++) {
+        base->push_back(numbered_triangle(i));
+        store.push_back(numbered_triangle(i + 1000000));
+    }
+    // and the shared triangles outlive the store they were shared from
+    base.reset();
+
+    REQUIRE(store.size() == 2 * shared);
+    for (std::size_t i = 0; i < shared; i++) {
+        REQUIRE(store.snapshot()[i] == numbered_triangle(i));
+        REQUIRE(store.snapshot()[shared + i] == numbered_triangle(shared + i + 1000000));
+    }
+}
+
+TEST_CASE("TriangleStore can be read while it's being appended to", "[TriangleStore]") {
+    TriangleStore store;
+    const std::size_t count = 100000;
+    std::atomic<bool> consistent = true;
+
+    std::thread reader([&] {
+        std::size_t seen = 0;
+        while (seen < count) {
+            TriangleStore::Snapshot snapshot = store.snapshot();
+            // snapshots must only ever grow
+            if (snapshot.size() < seen) {
+                consistent = false;
+            }
+            // every visible triangle must be completely written
+            for (std::size_t i = seen; i < snapshot.size(); i++) {
+                if (snapshot[i] != numbered_triangle(i)) {
+                    consistent = false;
+                }
+            }
+            seen = snapshot.size();
+        }
+    });
+
+    for (std::size_t i = 0; i < count; i++) {
+        store.push_back(numbered_triangle(i));
+    }
+    reader.join();
+
+    CHECK(consistent);
+}
+
+TEST_CASE("Drawing snapshot matches get_shapes()", "[TriangleStore][Drawing]") {
+    Drawing drawing({400, 300}, 20, 0, 1, 0.01, 90, {800, 600});
+    while (not drawing.is_complete()) {
+        drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
+    }
+
+    Drawing::Shapes shapes = drawing.get_shapes();
+    TriangleStore::Snapshot snapshot = drawing.snapshot();
+    REQUIRE(snapshot.size() == shapes.triangles.size());
+    for (std::size_t i = 0; i < snapshot.size(); i++) {
+        CHECK(Drawing::Shape(snapshot[i].begin(), snapshot[i].end()) == shapes.triangles[i]);
+    }
+}
+
+TEST_CASE("Drawing::changes_since() gives only the triangles added since", "[TriangleStore][Drawing]") {
+    Drawing drawing({400, 300}, 20, 0, 1, 0.01, 90, {800, 600});
+    std::vector<TriangleShape> seen;
+    std::size_t version = 0;
+    while (not drawing.is_complete()) {
+        drawing.add_triangles(3);
+        Drawing::Changes changes = drawing.changes_since(version);
+
+        CHECK(changes.version == drawing.version());
+        CHECK(changes.version - version == changes.triangles.size());
+        seen.insert(seen.end(), changes.triangles.begin(), changes.triangles.end());
+        version = changes.version;
+    }
+
+    TriangleStore::Snapshot all = drawing.snapshot();
+    CHECK(seen == std::vector<TriangleShape>(all.begin(), all.end()));
+    CHECK(drawing.changes_since(version).triangles.empty());
+}
@@ -0,0 +1,157 @@
+/*
+ * Counts heap allocations made while growing a Drawing, by replacing the
+ * global operator new for the whole test program.
+ *
+ * Only allocations made on the thread asking are counted, so tests running
+ * threads of their own elsewhere in the program don't throw the count off.
+ *
+ * It can also be made to fail an allocation on a background thread, to see
+ * that running out of memory there is passed on rather than ending the program.
+ */
+#include <cstddef>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    thread_local std::size_t allocations = 0;
+    // when set, the next allocation made on any thread other than the asker fails
+    std::atomic<bool> fail_next_elsewhere = false;
+    std::thread::id asker;
+
+    void* allocate(std::size_t size, std::size_t alignment) {
+        if (
+            fail_next_elsewhere.load(std::memory_order_relaxed) and std::this_thread::get_id() != asker
+            and fail_next_elsewhere.exchange(false)
+        ) {
+            throw std::bad_alloc();
+        }
+        allocations++;
+        // aligned_alloc() needs the size to be a multiple of the alignment
+        size = (std::max(size, (std::size_t)1) + alignment - 1) / alignment * alignment;
+        void* memory = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, size) : std::malloc(size);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    // a grid of small triangles spaced out for the Drawing to fill in between, so it grows big enough to warm up
+    std::vector<TriangleShape> seeds() {
+        std::vector<TriangleShape> triangles;
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                Point corner = {100.0 + x * 15, 100.0 + y * 15};
+                triangles.push_back({corner, corner + Vector{10, 0}, corner + Vector{0, 10}});
+            }
+        }
+        return triangles;
+    }
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate(size, (std::size_t)alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+TEST_CASE("Drawing::add_triangle() only allocates to grow its storage once warmed up", "[Drawing][allocations]") {
+    const std::size_t WARM_UP = 20;
+    const std::size_t TRIANGLES = 200;
+    // the vertex and triangle lists grow a chunk of this many at a time, and each triangle adds at most one vertex
+    const std::size_t CHUNK_SIZE = 64;
+    const std::size_t CHUNKED_LISTS = 2;
+    // everything else that grows along with the drawing doubles in size when full: the two chunked lists' tables
+    // of chunks, the shareable triangle store's chunks and their owners, the live vertex list and the two lists
+    // grouping it by triangle
+    std::size_t doubling_lists = 7;
+    Drawing drawing(seeds(), {400, 400});
+
+    SECTION("with no edge length bounds") {}
+
+    SECTION("with a maximum edge length") {
+        drawing.set_edge_length_bounds(0, 20);
+        // and the grid cells and close pairs it's searched by instead
+        doubling_lists += 2;
+    }
+
+    SECTION("with a scorer") {
+        drawing.set_edge_length_bounds(0, 20);
+        drawing.set_scorer([](const TriangleShape& triangle) { return triangle[0].x + triangle[0].y; });
+        // and the ranked candidates: the heap's four lists and the candidates it ranks, the pool of links
+        // they're indexed with, the lists of those by vertex and by cell, and the scratch list of those to recheck
+        doubling_lists += 9;
+    }
+
+    for (std::size_t t = 0; t < WARM_UP; t++) {
+        REQUIRE_FALSE(drawing.is_complete());
+        drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
+    }
+    std::size_t start = drawing.snapshot().size();
+    std::size_t total = 0;
+    std::size_t steps_allocating = 0;
+    for (std::size_t t = 0; t < TRIANGLES; t++) {
+        REQUIRE_FALSE(drawing.is_complete());
+        std::size_t before = allocations;
+        drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
+        total += allocations - before;
+        steps_allocating += allocations != before;
+    }
+
+    // the only allocations left are for storage growing along with the triangles added, which each list needs
+    // at most once per chunk or once per doubling, and they grow no faster than the triangles do
+    std::size_t chunks = (TRIANGLES + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::size_t doublings = 0;
+    for (std::size_t size = start; size < start + TRIANGLES; size *= 2) {
+        doublings++;
+    }
+    INFO(total << " allocations in " << steps_allocating << " of " << TRIANGLES << " steps");
+    CHECK(total <= CHUNKED_LISTS * chunks + doubling_lists * doublings);
+}
+
+TEST_CASE("TiledCanvas passes on running out of memory while growing a tile", "[TiledCanvas][allocations]") {
+    TiledCanvas canvas({400, 300}, 20, 0, 1, 0.01, 90, {200, 200}, 2);
+    Point top_left = {350, 250};
+    Vector size = {100, 100};
+    asker = std::this_thread::get_id();
+    fail_next_elsewhere = true;
+
+    // every tile is grown from the origin tile, so they all fail along with the first one grown
+    CHECK_THROWS_AS(canvas.wait(top_left, size), std::bad_alloc);
+    CHECK(canvas.is_ready(top_left, size));
+    CHECK_THROWS_AS(canvas.get_triangles(top_left, size), std::bad_alloc);
+    CHECK(canvas.tiles_grown() == 0);
+    CHECK_FALSE(fail_next_elsewhere);
+}
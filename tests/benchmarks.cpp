@@ -0,0 +1,94 @@
+/*
+ * Benchmarks are hidden from normal test runs. Run them with:
+ *   tests "[benchmark]"
+ */
+#include <cstddef>
+
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    struct Frame {
+        Percentage p;
+        Degrees angle;
+        Degrees base_angle;
+    };
+
+    // a spread of frames from the viewer's (angle, p) sweep
+    const std::array<Frame, 6> FRAMES = {{
+        {0.01, 45.0, -33.75},
+        {0.01, 60.0, -45.0},
+        {0.01, 10.0, -7.5},
+        {0.30, 45.0, -33.75},
+        {0.30, 90.0, -67.5},
+        {0.50, 60.0, -45.0},
+    }};
+
+    // builds every frame just like the viewer does, returning triangles built
+    std::size_t build_frames(std::pmr::memory_resource* resource, std::pmr::monotonic_buffer_resource* arena) {
+        std::size_t triangles = 0;
+        for (const Frame& frame : FRAMES) {
+            {
+                Drawing drawing({400, 300}, 20, frame.base_angle, 1, frame.p, frame.angle, {800, 600}, resource);
+                std::size_t give_up = 0;
+                while (not drawing.is_complete() and give_up < 200) {
+                    drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
+                    give_up++;
+                }
+                triangles += drawing.snapshot().size();
+            }
+            // per-frame arena reset, once the Drawing has been destroyed
+            if (arena != nullptr) {
+                arena->release();
+            }
+        }
+        return triangles;
+    }
+}
+
+TEST_CASE("Drawing allocator benchmarks", "[.][benchmark]") {
+    BENCHMARK("default memory resource") {
+        return build_frames(std::pmr::get_default_resource(), nullptr);
+    };
+
+    BENCHMARK_ADVANCED("monotonic arena, released per frame")(Catch::Benchmark::Chronometer meter) {
+        std::pmr::monotonic_buffer_resource arena;
+        meter.measure([&] {
+            return build_frames(&arena, &arena);
+        });
+    };
+}
+
+TEST_CASE("build_many() benchmarks", "[.][benchmark]") {
+    // enough frames from the viewer's sweep to keep every thread busy
+    Sweep sweep;
+    std::vector<AnimationFrame> frames(240);
+    for (AnimationFrame& frame : frames) {
+        frame = sweep.next();
+    }
+
+    BENCHMARK("one at a time") {
+        std::size_t triangles = 0;
+        for (const AnimationFrame& frame : frames) {
+            triangles += build_frame(frame).snapshot().size();
+        }
+        return triangles;
+    };
+
+    BENCHMARK("build_many()") {
+        std::size_t triangles = 0;
+        for (const Drawing& drawing : build_many(frames)) {
+            triangles += drawing.snapshot().size();
+        }
+        return triangles;
+    };
+}
@@ -1,10 +1,16 @@
+#include <cstddef>
+#include <cstdint>
+
 #include <algorithm>
 #include <vector>
 
 #include <catch2/catch.hpp>
 
 #include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
 #include <triangberg_builder/geometry.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
 
 using namespace com::saxbophone::triangberg;
 
@@ -105,6 +111,28 @@ TEST_CASE("subtend_point_from_vector", "[geometry]") {
     CHECK(result.y == Approx(destination.y));
 }
 
+TEST_CASE("subtend_points_from_vectors", "[geometry]") {
+    std::vector<Point> origins = {{4, 9}, {10, 6}, {-3.5, 2}, {0, 0}, {100, 200}};
+    std::vector<Vector> vs = {{-3, -6}, {2, -3}, {1, 1}, {0, 0}, {-40.25, 17}};
+    Radians theta = degrees_to_radians(60);
+    std::vector<Unit> origin_x, origin_y, v_x, v_y;
+    for (std::size_t i = 0; i < origins.size(); i++) {
+        origin_x.push_back(origins[i].x);
+        origin_y.push_back(origins[i].y);
+        v_x.push_back(vs[i].x);
+        v_y.push_back(vs[i].y);
+    }
+    std::vector<Unit> out_x(origins.size()), out_y(origins.size());
+
+    subtend_points_from_vectors(origin_x, origin_y, v_x, v_y, theta, out_x, out_y);
+
+    for (std::size_t i = 0; i < origins.size(); i++) {
+        Point expected = subtend_point_from_vector(origins[i], vs[i], theta);
+        CHECK(out_x[i] == Approx(expected.x));
+        CHECK(out_y[i] == Approx(expected.y));
+    }
+}
+
 TEST_CASE("are_intersecting", "[geometry]") {
     const Line A = {{ 2, 10}, { 9, 15}};
     const Line B = {{ 6, 14}, { 3,  9}};
@@ -194,3 +222,86 @@ TEST_CASE("is_concave", "[geometry]") {
         CHECK(is_concave(shape));
     }
 }
+
+TEST_CASE("are_intersecting() for triangles", "[geometry]") {
+    const TriangleShape A = {{{0, 0}, {10, 0}, {0, 10}}};
+
+    SECTION("crossing triangles intersect") {
+        CHECK(are_intersecting(A, {{{5, -5}, {5, 5}, {15, 5}}}));
+    }
+
+    SECTION("triangles far apart don't") {
+        CHECK_FALSE(are_intersecting(A, {{{20, 20}, {30, 20}, {20, 30}}}));
+    }
+
+    SECTION("triangles sharing a corner or an edge don't") {
+        CHECK_FALSE(are_intersecting(A, {{{10, 0}, {20, 0}, {10, 10}}}));
+        CHECK_FALSE(are_intersecting(A, {{{10, 0}, {0, 10}, {10, 10}}}));
+    }
+
+    SECTION("a triangle with a corner partway along another's edge doesn't") {
+        CHECK_FALSE(are_intersecting(A, {{{5, 5}, {10, 10}, {15, 0}}}));
+        CHECK_FALSE(are_intersecting(A, {{{5, 0}, {10, -5}, {0, -5}}}));
+    }
+
+    SECTION("a triangle inside another does, either way round") {
+        const TriangleShape inside = {{{1, 1}, {4, 1}, {1, 4}}};
+
+        CHECK(are_intersecting(A, inside));
+        CHECK(are_intersecting(inside, A));
+    }
+
+    SECTION("a triangle overlapping another along part of a shared edge does") {
+        CHECK(are_intersecting(A, {{{0, 0}, {5, 0}, {2, 2}}}));
+    }
+
+    SECTION("the same triangle does, whichever way round its corners go") {
+        CHECK(are_intersecting(A, A));
+        CHECK(are_intersecting(A, {{A[2], A[1], A[0]}}));
+    }
+}
+
+TEST_CASE("find_intersecting_triangles() finds the same pairs as testing every pair", "[geometry]") {
+    // a grid of triangles, some of which have been pushed into their neighbours
+    std::vector<TriangleShape> triangles;
+    for (int y = 0; y < 6; y++) {
+        for (int x = 0; x < 6; x++) {
+            Point corner = {x * 10.0 + (x * y % 4 == 3 ? 6 : 0), y * 10.0 + (x + y) % 3};
+            triangles.push_back({corner, corner + Vector{8, 1}, corner + Vector{2, 8}});
+        }
+    }
+    std::vector<TrianglePair> expected;
+    for (std::size_t a = 0; a < triangles.size(); a++) {
+        for (std::size_t b = a + 1; b < triangles.size(); b++) {
+            if (are_intersecting(triangles[a], triangles[b])) {
+                expected.push_back({a, b});
+            }
+        }
+    }
+    // otherwise, this isn't testing much
+    REQUIRE_FALSE(expected.empty());
+
+    CHECK(find_intersecting_triangles(triangles) == expected);
+
+    SECTION("in whatever order the triangles come") {
+        std::reverse(triangles.begin(), triangles.end());
+        for (TrianglePair& pair : expected) {
+            pair = {triangles.size() - 1 - pair.second, triangles.size() - 1 - pair.first};
+        }
+        std::sort(
+            expected.begin(), expected.end(),
+            [](const TrianglePair& a, const TrianglePair& b) {
+                return a.first < b.first or (a.first == b.first and a.second < b.second);
+            }
+        );
+
+        CHECK(find_intersecting_triangles(triangles) == expected);
+    }
+
+    SECTION("none in a drawing") {
+        Drawing drawing({400, 300}, 20, 0, 1, 0.01, 90, {800, 600});
+        drawing.add_triangles(SIZE_MAX);
+
+        CHECK(drawing.find_intersecting_triangles().empty());
+    }
+}
@@ -0,0 +1,170 @@
+/*
+ * End-to-end regression corpus: a spread of frames from the viewer's sweep,
+ * each built in full and checked against the triangles it built before.
+ *
+ * The golden hashes catch any change to which triangles are placed. If a
+ * change to the output is intended, update them from the failure messages.
+ * Every frame is also checked for intersecting triangles, which no change
+ * should ever let through.
+ *
+ * The timings are hidden from normal test runs, as they only mean something
+ * in optimised builds. Run them with:
+ *   tests "[timing]"
+ * which fails if any frame builds more than TRIANGBERG_REGRESSION_SLOWDOWN
+ * times slower than in regression_timings.txt (1.5 times, if not set). To
+ * record new timings for this machine instead, set TRIANGBERG_REGRESSION_RECORD.
+ */
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    struct Frame {
+        const char* name;
+        Percentage p;
+        Degrees angle;
+        Degrees base_angle;
+        // what it should build
+        std::size_t triangles;
+        std::uint64_t hash;
+    };
+
+    // in case a change to the builder stops a frame from ever completing
+    const std::size_t MAX_TRIANGLES = 1000;
+
+    // from across the viewer's sweep of angle in (0.1, 119.9) and p in (0.01, 0.99), with the busiest frames
+    const std::array<Frame, 14> CORPUS = {{
+        {"narrow", 0.01, 0.5, -0.375, 4, 0xc7902eac9d9b2209},
+        {"acute", 0.01, 10.0, -7.5, 4, 0x0d622299ff8a5d92},
+        {"square-ish", 0.01, 45.0, -33.75, 4, 0x86aa95b1b97ec380},
+        {"equilateral", 0.01, 60.0, -45.0, 7, 0x3d7e4747382d77f8},
+        {"nearly-right", 0.01, 86.1, -64.575, 21, 0x9268504458376f40},
+        {"right", 0.01, 90.0, -67.5, 21, 0x04b93e5e655aabd5},
+        {"obtuse", 0.01, 116.2, -87.15, 22, 0x2efe76d4da189ce2},
+        {"widest", 0.01, 119.9, -89.925, 4, 0x0073f2100e310c11},
+        {"early-obtuse", 0.08, 99.0, -74.25, 21, 0x1faa29f03372c504},
+        {"quarter-acute", 0.25, 30.0, -22.5, 4, 0x3253215367148ff7},
+        {"half-equilateral", 0.50, 60.0, -45.0, 7, 0xe70b19df80709f17},
+        {"half-obtuse", 0.50, 110.0, -82.5, 4, 0x681a28964c46acb4},
+        {"late-acute", 0.85, 20.0, -15.0, 7, 0xeec43ea6ff7de186},
+        {"late-right", 0.99, 90.0, -67.5, 4, 0xbf1c0519602bd66b},
+    }};
+
+    // what a frame built
+    struct Outcome {
+        std::size_t triangles;
+        std::uint64_t hash; // FNV-1a over the bytes of every corner, in the order the triangles were added
+    };
+
+    Drawing build(const Frame& frame) {
+        Drawing drawing({400, 300}, 20, frame.base_angle, 1, frame.p, frame.angle, {800, 600});
+        drawing.add_triangles(MAX_TRIANGLES);
+        return drawing;
+    }
+
+    Outcome outcome_of(const Drawing& drawing) {
+        Outcome outcome = {0, 14695981039346656037ull};
+        for (const TriangleShape& triangle : drawing.snapshot()) {
+            for (Point corner : triangle) {
+                unsigned char bytes[sizeof(Unit) * 2];
+                std::memcpy(bytes, &corner.x, sizeof(Unit));
+                std::memcpy(bytes + sizeof(Unit), &corner.y, sizeof(Unit));
+                for (unsigned char byte : bytes) {
+                    outcome.hash ^= byte;
+                    outcome.hash *= 1099511628211ull;
+                }
+            }
+            outcome.triangles++;
+        }
+        return outcome;
+    }
+
+    const char* const TIMINGS_PATH = "regression_timings.txt";
+
+    // milliseconds each frame took to build, by name
+    std::map<std::string, double> read_timings() {
+        std::map<std::string, double> timings;
+        std::ifstream file(TIMINGS_PATH);
+        std::string name;
+        double milliseconds;
+        while (file >> name >> milliseconds) {
+            timings[name] = milliseconds;
+        }
+        return timings;
+    }
+
+    // average milliseconds per build, over enough builds that the clock's resolution doesn't matter
+    double time_to_build(const Frame& frame) {
+        using namespace std::chrono_literals;
+        double fastest = INFINITY;
+        // the fastest of a few rounds, to keep out noise from the rest of the system
+        for (int round = 0; round < 3; round++) {
+            std::size_t builds = 0;
+            auto start = std::chrono::steady_clock::now();
+            std::chrono::duration<double, std::milli> taken;
+            do {
+                build(frame);
+                builds++;
+                taken = std::chrono::steady_clock::now() - start;
+            } while (taken < 50ms);
+            fastest = std::min(fastest, taken.count() / (double)builds);
+        }
+        return fastest;
+    }
+}
+
+TEST_CASE("Regression corpus builds the same triangles as before", "[regression]") {
+    for (const Frame& frame : CORPUS) {
+        Drawing drawing = build(frame);
+        Outcome outcome = outcome_of(drawing);
+
+        INFO(frame.name << " built " << outcome.triangles << " triangles, hash 0x" << std::hex << outcome.hash);
+        CHECK(outcome.triangles == frame.triangles);
+        CHECK(outcome.hash == frame.hash);
+        CHECK(drawing.find_intersecting_triangles().empty());
+    }
+}
+
+TEST_CASE("Regression corpus builds no slower than before", "[.][regression][timing]") {
+    const char* slowdown_variable = std::getenv("TRIANGBERG_REGRESSION_SLOWDOWN");
+    double slowdown = slowdown_variable != nullptr ? std::atof(slowdown_variable) : 1.5;
+    bool record = std::getenv("TRIANGBERG_REGRESSION_RECORD") != nullptr;
+    std::map<std::string, double> baseline = read_timings();
+    REQUIRE((record or not baseline.empty()));
+
+    std::map<std::string, double> timings;
+    for (const Frame& frame : CORPUS) {
+        timings[frame.name] = time_to_build(frame);
+    }
+
+    if (record) {
+        std::ofstream file(TIMINGS_PATH, std::ios::trunc);
+        for (const Frame& frame : CORPUS) {
+            file << frame.name << ' ' << timings[frame.name] << '\n';
+        }
+        return;
+    }
+    for (const Frame& frame : CORPUS) {
+        INFO(frame.name << " took " << timings[frame.name] << "ms, baseline " << baseline[frame.name] << "ms");
+        REQUIRE(baseline.contains(frame.name));
+        CHECK(timings[frame.name] <= baseline[frame.name] * slowdown);
+    }
+}
@@ -0,0 +1,34 @@
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <triangberg_builder/RenderService.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 or argc > 4) {
+        std::fprintf(stderr, "usage: %s <socket path> [threads] [cache size]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    std::size_t cache_size = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+    // block these before any threads start, so that only sigwait() below ever sees them
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    RenderService service(argv[1], threads, cache_size);
+    if (not service.is_listening()) {
+        std::fprintf(stderr, "couldn't listen on %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    int signal;
+    sigwait(&stop_signals, &signal);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#include <memory_resource>
+#include <thread>
+
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/FrameRing.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+namespace {
+    volatile std::sig_atomic_t stopping = 0;
+
+    void stop(int) {
+        stopping = 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 or argc > 5) {
+        std::fprintf(stderr, "usage: %s <ring name> [generator] [generators] [slots]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    // generator g of n builds frames g, g + n, g + 2n and so on of the viewer's sweep
+    std::size_t generator = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    std::size_t generators = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+    std::size_t slots = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 4;
+    if (generators == 0 or generator >= generators) {
+        std::fprintf(stderr, "generator must be less than generators\n");
+        return EXIT_FAILURE;
+    }
+    // stop cleanly, so that the ring is removed
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    FrameRingWriter ring(argv[1], slots);
+    if (not ring.is_open()) {
+        std::fprintf(stderr, "couldn't create %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    Sweep sweep;
+    for (std::size_t f = 0; f < generator; f++) {
+        sweep.next();
+    }
+    std::pmr::monotonic_buffer_resource arena;
+    while (not stopping) {
+        AnimationFrame frame = sweep.next();
+        for (std::size_t f = 1; f < generators; f++) {
+            sweep.next();
+        }
+        {
+            Drawing drawing = build_frame(frame, 10000, &arena);
+            // the viewer draws at most one frame from us every frame it shows, so there's no hurry to check again
+            while (not ring.write(frame, drawing) and not stopping) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        arena.release();
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <filesystem>
+#include <iostream>
+
+#include <triangberg_builder/Animation.hpp>
+
+using namespace com::saxbophone::triangberg;
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 or argc > 5) {
+        std::fprintf(
+            stderr,
+            "usage: %s <frames> [first frame] [threads] [PPM directory]\n"
+            "writes a Y4M video to stdout, or numbered PPM images if a directory is given\n",
+            argv[0]
+        );
+        return EXIT_FAILURE;
+    }
+    AnimationSettings settings = {};
+    settings.frames = std::strtoull(argv[1], nullptr, 10);
+    settings.first_frame = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    settings.threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+    if (argc > 4) {
+        std::filesystem::path directory = argv[4];
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            std::fprintf(stderr, "couldn't create %s: %s\n", argv[4], error.message().c_str());
+            return EXIT_FAILURE;
+        }
+        PpmSequenceSink sink(directory);
+        render_animation(settings, sink);
+    } else {
+        // frames are big, so don't have stdout flushed after every bit of each one
+        std::ios::sync_with_stdio(false);
+        Y4mSink sink(std::cout);
+        render_animation(settings, sink);
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,18 +1,277 @@
+#include <chrono>
 #include <cmath>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
 
 #include <SFML/Graphics.hpp>
 
+#include <triangberg_builder/Animation.hpp>
 #include <triangberg_builder/Drawing.hpp>
+#ifdef TRIANGBERG_SHARED_MEMORY
+#include <triangberg_builder/FrameRing.hpp>
+#endif
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+#include <triangberg_builder/trace.hpp>
 
 // fudge factor, for scaling up graphics. Will do for demos for now.
 // TODO: replace with automatic scaling of image to-screen size based on drawing
 // size.
 const std::size_t SCALE = 28;
 
-int main() {
+// how much of each frame (at 60 FPS) may be spent building that frame's drawing
+const std::chrono::milliseconds BUILD_BUDGET(12);
+
+// size of each tile of the pannable canvas, comfortably bigger than its initial triangle
+const float TILE_SIZE = 200;
+
+namespace {
     using namespace com::saxbophone::triangberg;
 
+    // a tiny built-in font, so that the HUD doesn't need a font file
+    // each glyph is 3x5 pixels: 5 rows of 3 bits, top row first and leftmost pixel in the highest bit
+    struct Glyph {
+        char character;
+        std::uint16_t rows;
+    };
+
+    constexpr std::uint16_t glyph(int r0, int r1, int r2, int r3, int r4) {
+        return (std::uint16_t)(r0 << 12 | r1 << 9 | r2 << 6 | r3 << 3 | r4);
+    }
+
+    const Glyph FONT[] = {
+        {'0', glyph(07, 05, 05, 05, 07)}, {'1', glyph(02, 06, 02, 02, 07)},
+        {'2', glyph(07, 01, 07, 04, 07)}, {'3', glyph(07, 01, 07, 01, 07)},
+        {'4', glyph(05, 05, 07, 01, 01)}, {'5', glyph(07, 04, 07, 01, 07)},
+        {'6', glyph(07, 04, 07, 05, 07)}, {'7', glyph(07, 01, 01, 01, 01)},
+        {'8', glyph(07, 05, 07, 05, 07)}, {'9', glyph(07, 05, 07, 01, 07)},
+        {'A', glyph(02, 05, 07, 05, 05)}, {'B', glyph(06, 05, 06, 05, 06)},
+        {'C', glyph(03, 04, 04, 04, 03)}, {'D', glyph(06, 05, 05, 05, 06)},
+        {'E', glyph(07, 04, 06, 04, 07)}, {'F', glyph(07, 04, 06, 04, 04)},
+        {'G', glyph(03, 04, 05, 05, 03)}, {'H', glyph(05, 05, 07, 05, 05)},
+        {'I', glyph(07, 02, 02, 02, 07)}, {'J', glyph(01, 01, 01, 05, 02)},
+        {'K', glyph(05, 05, 06, 05, 05)}, {'L', glyph(04, 04, 04, 04, 07)},
+        {'M', glyph(05, 07, 07, 05, 05)}, {'N', glyph(06, 05, 05, 05, 05)},
+        {'O', glyph(02, 05, 05, 05, 02)}, {'P', glyph(06, 05, 06, 04, 04)},
+        {'Q', glyph(02, 05, 05, 06, 03)}, {'R', glyph(06, 05, 06, 05, 05)},
+        {'S', glyph(03, 04, 02, 01, 06)}, {'T', glyph(07, 02, 02, 02, 02)},
+        {'U', glyph(05, 05, 05, 05, 07)}, {'V', glyph(05, 05, 05, 05, 02)},
+        {'W', glyph(05, 05, 07, 07, 05)}, {'X', glyph(05, 05, 02, 05, 05)},
+        {'Y', glyph(05, 05, 02, 02, 02)}, {'Z', glyph(07, 01, 02, 04, 07)},
+        {'.', glyph(00, 00, 00, 00, 02)}, {':', glyph(00, 02, 00, 02, 00)},
+        {'-', glyph(00, 00, 07, 00, 00)}, {'/', glyph(01, 01, 02, 04, 04)},
+        {'%', glyph(05, 01, 02, 04, 05)}, {'=', glyph(00, 07, 00, 07, 00)},
+        {'(', glyph(01, 02, 02, 02, 01)}, {')', glyph(04, 02, 02, 02, 04)},
+    };
+
+    // blank for anything not in the font
+    std::uint16_t glyph_for(char c) {
+        if (c >= 'a' and c <= 'z') {
+            c = (char)(c - 'a' + 'A');
+        }
+        for (const Glyph& g : FONT) {
+            if (g.character == c) {
+                return g.rows;
+            }
+        }
+        return 0;
+    }
+
+    // everything shown on the HUD, besides the frame-time graph
+    struct HudFigures {
+        float frame_ms;
+        float build_ms;
+        std::size_t triangles;
+        Drawing::Stats stats;
+        Degrees angle;
+        Percentage p;
+        Unit base_angle;
+    };
+
+    // on-screen overlay of live performance figures, with a rolling graph of frame times
+    // NOTE: it's rebuilt every frame in the same vertex array and text buffer, so once they've
+    // grown big enough the first time, showing it doesn't allocate and barely costs anything
+    class Hud {
+    public:
+        void record_frame(float frame_ms) {
+            this->_frame_times[this->_next] = frame_ms;
+            this->_next = (this->_next + 1) % this->_frame_times.size();
+        }
+
+        void draw(sf::RenderTarget& target, const HudFigures& figures) {
+            this->_vertices.clear();
+            this->rectangle(4, 4, 400, 136, sf::Color(0, 0, 0, 160));
+            float y = 10;
+            this->line(
+                y, "FRAME %5.1f MS  %5.1f FPS  BUILD %5.1f MS",
+                figures.frame_ms, figures.frame_ms > 0 ? 1000 / figures.frame_ms : 0, figures.build_ms
+            );
+            this->line(
+                y, "TRIANGLES %zu  PAIRS %zu  CANDIDATES %zu",
+                figures.triangles, figures.stats.pairs_tried, figures.stats.candidates
+            );
+            this->line(
+                y, "REJECTED: USED %zu SHARED %zu SIZE %zu",
+                figures.stats.rejected_ineligible, figures.stats.rejected_shared, figures.stats.rejected_size
+            );
+            this->line(
+                y, "  OFF SCREEN %zu  COVERED %zu  OVERLAP %zu",
+                figures.stats.rejected_off_screen, figures.stats.rejected_covered,
+                figures.stats.rejected_intersecting
+            );
+            this->line(
+                y, "ANGLE %6.2f  P %4.2f  BASE %7.2f",
+                figures.angle, figures.p, figures.base_angle
+            );
+            // oldest frame on the left, with a line marking 60 FPS
+            float bottom = 136;
+            for (std::size_t i = 0; i < this->_frame_times.size(); i++) {
+                float ms = this->_frame_times[(this->_next + i) % this->_frame_times.size()];
+                float height = std::min(ms * GRAPH_SCALE, GRAPH_HEIGHT);
+                sf::Color colour = ms <= FRAME_TARGET_MS ? sf::Color::Green : sf::Color::Red;
+                this->rectangle(10 + (float)i * 3, bottom - height, 2, height, colour);
+            }
+            this->rectangle(10, bottom - FRAME_TARGET_MS * GRAPH_SCALE, (float)this->_frame_times.size() * 3, 1, sf::Color::White);
+            target.draw(this->_vertices);
+        }
+
+    private:
+        static constexpr float PIXEL = 2; // size of each pixel of the font
+        static constexpr float LINE_HEIGHT = 7 * PIXEL;
+        static constexpr float FRAME_TARGET_MS = 1000.0f / 60;
+        static constexpr float GRAPH_SCALE = 1.5f; // pixels per millisecond
+        static constexpr float GRAPH_HEIGHT = 50;
+
+        // formats a line of text into the reused buffer and adds it below the last one
+        template <typename... Args>
+        void line(float& y, const char* format, Args... args) {
+            std::snprintf(this->_text.data(), this->_text.size(), format, args...);
+            this->text(10, y, this->_text.data());
+            y += LINE_HEIGHT;
+        }
+
+        void text(float x, float y, const char* string) {
+            for (; *string != '\0'; string++, x += 4 * PIXEL) {
+                std::uint16_t rows = glyph_for(*string);
+                for (int row = 0; row < 5; row++) {
+                    for (int column = 0; column < 3; column++) {
+                        if (rows & (1 << (14 - row * 3 - column))) {
+                            this->rectangle(x + (float)column * PIXEL, y + (float)row * PIXEL, PIXEL, PIXEL, sf::Color::White);
+                        }
+                    }
+                }
+            }
+        }
+
+        void rectangle(float x, float y, float width, float height, sf::Color colour) {
+            this->_vertices.append(sf::Vertex(sf::Vector2f(x, y), colour));
+            this->_vertices.append(sf::Vertex(sf::Vector2f(x + width, y), colour));
+            this->_vertices.append(sf::Vertex(sf::Vector2f(x + width, y + height), colour));
+            this->_vertices.append(sf::Vertex(sf::Vector2f(x, y + height), colour));
+        }
+
+        sf::VertexArray _vertices{sf::Quads};
+        std::array<char, 128> _text{};
+        std::array<float, 128> _frame_times{}; // rolling, oldest overwritten first
+        std::size_t _next = 0;
+    };
+
+    // adds a triangle to the vertex array, shaded red, green and blue from one corner to the next
+    void append_triangle(sf::VertexArray& vertices, const TriangleShape& triangle) {
+        const sf::Color colours[] = {
+            sf::Color::Red, sf::Color::Green, sf::Color::Blue,
+        };
+        for (std::size_t i = 0; i < 3; i++) {
+            vertices.append(sf::Vertex(sf::Vector2f((float)triangle[i].x, (float)triangle[i].y), colours[i]));
+        }
+    }
+
+#ifdef TRIANGBERG_SHARED_MEMORY
+    // frame rings are laid out like SFML's own vertices, so their frames can be drawn straight from shared memory
+    static_assert(sizeof(FrameVertex) == sizeof(sf::Vertex));
+    static_assert(offsetof(FrameVertex, red) == offsetof(sf::Vertex, color));
+    static_assert(offsetof(FrameVertex, texture_x) == offsetof(sf::Vertex, texCoords));
+
+    // frames built by generator processes, shown taking turns between their rings in the order given
+    class SharedFrames {
+    public:
+        bool attach(const char* name) {
+            this->_rings.push_back(std::make_unique<FrameRingReader>(name));
+            return this->_rings.back()->is_open();
+        }
+
+        bool empty() const {
+            return this->_rings.empty();
+        }
+
+        // moves on to the next generator's frame as soon as it's ready, only then finishing with the one shown
+        void advance(HudFigures& figures) {
+            FrameRingReader& shown = *this->_rings[this->_current];
+            std::size_t next = (this->_current + 1) % this->_rings.size();
+            // with only one ring, the next frame is queued up behind the one shown
+            std::size_t needed = next == this->_current ? 2 : 1;
+            if (shown.available() > 0 and this->_rings[next]->available() >= needed) {
+                shown.pop();
+                this->_current = next;
+            }
+            if (std::optional<RingFrame> frame = this->_rings[this->_current]->peek()) {
+                figures.triangles = frame->vertices.size() / 3;
+                figures.angle = frame->parameters.angle;
+                figures.p = frame->parameters.p;
+                figures.base_angle = frame->parameters.base_angle;
+            }
+        }
+
+        void draw(sf::RenderTarget& target) const {
+            if (std::optional<RingFrame> frame = this->_rings[this->_current]->peek()) {
+                target.draw((const sf::Vertex*)frame->vertices.data(), frame->vertices.size(), sf::Triangles);
+            }
+        }
+
+    private:
+        std::vector<std::unique_ptr<FrameRingReader>> _rings;
+        std::size_t _current = 0;
+    };
+#else
+    // there's no shared memory to find generators in here
+    class SharedFrames {
+    public:
+        bool attach(const char*) {
+            return false;
+        }
+
+        bool empty() const {
+            return true;
+        }
+
+        void advance(HudFigures&) {}
+
+        void draw(sf::RenderTarget&) const {}
+    };
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    // frames can come from generator processes instead (see triangberg-generate), given by the names of their rings
+    SharedFrames shared;
+    for (int a = 1; a < argc; a++) {
+        if (not shared.attach(argv[a])) {
+            std::fprintf(stderr, "couldn't attach to frame ring %s\n", argv[a]);
+            return EXIT_FAILURE;
+        }
+    }
+
     sf::ContextSettings settings;
     settings.antialiasingLevel = 8;
 
@@ -22,9 +281,8 @@ int main() {
     // don't kill my CPU by running at stupid-fast framerate for no reason
     window.setFramerateLimit(60);
 
-    Degrees angle = 0.1;
-    Percentage p = 0.01;
-    Unit base_angle = 0;
+    // the same schedule of frames as triangberg-render, so videos match what's shown here
+    Sweep sweep;
 
     sf::Event event;
     // click when ready to start
@@ -32,11 +290,35 @@ int main() {
         window.pollEvent(event);
     } while (event.type != sf::Event::MouseButtonPressed);
 
-    Degrees angle_delta = 0.1;
-    Unit p_delta = 0.01;
+    // each frame's Drawing is built in this arena, which is reset every frame
+    std::pmr::monotonic_buffer_resource arena;
+    // press P to build each frame's Drawing across as many frames as it takes, instead of only what fits in one
+    bool progressive = false;
+    AnimationFrame frame = {};
+    std::optional<Drawing> drawing;
+    // triangles of the current Drawing, ready to draw in one go and only added to as it grows
+    sf::VertexArray render_buffer(sf::Triangles);
+    std::size_t render_buffer_version = 0; // version of the Drawing that render_buffer is up to
+
+    // press T to freeze the sweep on the current frame's parameters and grow them out into a canvas without edges,
+    // which can be panned with the arrow keys and zoomed with the mouse wheel, growing only the tiles in view
+    std::optional<TiledCanvas> tiled;
+    sf::View view = window.getDefaultView();
+    sf::VertexArray tiled_buffer(sf::Triangles);
+    sf::FloatRect tiled_shown; // area of the canvas that tiled_buffer shows
+    std::size_t tiled_grown = 0; // how many tiles had been grown when tiled_buffer was filled
+
+    // press H to show or hide it
+    Hud hud;
+    bool show_hud = true;
+    auto last_frame_start = std::chrono::steady_clock::now();
 
     // run the program as long as the window is open
     while (window.isOpen()) {
+        auto frame_start = std::chrono::steady_clock::now();
+        std::chrono::duration<float, std::milli> frame_time = frame_start - last_frame_start;
+        last_frame_start = frame_start;
+        hud.record_frame(frame_time.count());
         // check all the window's events that were triggered since the last iteration of the loop
 
         while (window.pollEvent(event)) {
@@ -44,66 +326,134 @@ int main() {
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
+            if (event.type == sf::Event::KeyPressed and event.key.code == sf::Keyboard::H) {
+                show_hud = not show_hud;
+            }
+            if (event.type == sf::Event::KeyPressed and event.key.code == sf::Keyboard::P) {
+                progressive = not progressive;
+            }
+            if (event.type == sf::Event::KeyPressed and event.key.code == sf::Keyboard::T and drawing) {
+                if (tiled) {
+                    tiled.reset();
+                } else {
+                    tiled.emplace(
+                        Point{400, 300}, 20, frame.base_angle, 1, frame.p, frame.angle, Vector{TILE_SIZE, TILE_SIZE}
+                    );
+                    view = window.getDefaultView();
+                    tiled_buffer.clear();
+                    tiled_shown = {};
+                    tiled_grown = 0;
+                }
+            }
+            if (tiled and event.type == sf::Event::KeyPressed) {
+                // a tenth of the view at a time
+                sf::Vector2f step = {view.getSize().x / 10, view.getSize().y / 10};
+                switch (event.key.code) {
+                case sf::Keyboard::Left:
+                    view.move(-step.x, 0);
+                    break;
+                case sf::Keyboard::Right:
+                    view.move(step.x, 0);
+                    break;
+                case sf::Keyboard::Up:
+                    view.move(0, -step.y);
+                    break;
+                case sf::Keyboard::Down:
+                    view.move(0, step.y);
+                    break;
+                default:
+                    break;
+                }
+            }
+            if (tiled and event.type == sf::Event::MouseWheelScrolled) {
+                view.zoom(event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f);
+            }
         }
 
-        // create the Drawing object
-        Drawing drawing({400, 300}, 20, base_angle, 1, p, angle, {800, 600});
-        std::size_t give_up = 0;
-        while (not drawing.is_complete() and give_up < 200) {
-            // dummy lambda --we don't care about it as it's not currently used
-            drawing.add_triangle([](std::size_t)->std::size_t {return 0;});
-            give_up++;
-        }
-        std::cout << "p: " << p << " angle: " << angle << std::endl;
-
-        angle += angle_delta;
-        base_angle -= (angle_delta * 0.75);
-        if (0.1 >= angle or angle >= 119.9) {
-            angle_delta *= -1;
-            p += p_delta;
-            if (0.01 >= p or p >= 0.99) {
-                p_delta *= -1;
+        // shown on the HUD once drawn, before they move on to next frame's
+        HudFigures figures = {frame_time.count(), 0, 0, {}, 0, 0, 0};
+        Drawing::Changes changes = {};
+        if (not shared.empty()) {
+            shared.advance(figures);
+        } else if (tiled) {
+            sf::FloatRect shown(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+            Point top_left = {shown.left, shown.top};
+            Vector size = {shown.width, shown.height};
+            // grows whatever tiles have come into view in the background, leaving the last view on screen until then
+            tiled->request(top_left, size);
+            std::size_t grown = tiled->tiles_grown();
+            if (tiled->is_ready(top_left, size) and (shown != tiled_shown or grown != tiled_grown)) {
+                tiled_buffer.clear();
+                for (const TriangleShape& triangle : tiled->get_triangles(top_left, size)) {
+                    append_triangle(tiled_buffer, triangle);
+                }
+                tiled_shown = shown;
+                tiled_grown = grown;
+            }
+            figures = {
+                frame_time.count(), 0, tiled_buffer.getVertexCount() / 3, {},
+                frame.angle, frame.p, frame.base_angle,
+            };
+        } else {
+            if (not progressive or not drawing or drawing->is_complete()) {
+                // the last Drawing is done with, so its memory can be reclaimed
+                drawing.reset();
+                arena.release();
+                // create the Drawing object
+                frame = sweep.next();
+                drawing.emplace(Point{400, 300}, 20, frame.base_angle, 1, frame.p, frame.angle, Vector{800, 600}, &arena);
+                render_buffer.clear();
+                render_buffer_version = 0;
             }
+            // build as much of it as we can afford to this frame, carrying on from where the last frame left off
+            drawing->grow_until(frame_start + BUILD_BUDGET);
+            std::chrono::duration<float, std::milli> build_time = std::chrono::steady_clock::now() - frame_start;
+            changes = drawing->changes_since(render_buffer_version);
+            figures = {
+                frame_time.count(), build_time.count(), changes.version, drawing->get_stats(),
+                frame.angle, frame.p, frame.base_angle,
+            };
         }
 
-        // clear the window with black color
-        window.clear(sf::Color::Black);
+        {
+            TRIANGBERG_TRACE_ZONE("draw");
+            // clear the window with black color
+            window.clear(sf::Color::Black);
 
-        // draw everything here...
-        Drawing::Shapes shapes = drawing.get_shapes();
-        // draw all the triangles first
-        // don't ever draw more than 200 objects
-        std::size_t drawn = 0;
-        for (const Drawing::Shape& t : shapes.triangles) {
-            if (drawn >= 200) {
-                break;
-            }
-            sf::VertexArray triangle(sf::Triangles, 3);
-            // colours to use for each vertex
-            sf::Color colours[] = {
-                sf::Color::Red, sf::Color::Green, sf::Color::Blue,
-            };
-            for (std::size_t i = 0; i < 3; i++) {
-                // define the position of the triangle's points
-                triangle[i].position = sf::Vector2f(t[i].x, t[i].y);
-                // define the color of the triangle's points
-                triangle[i].color = colours[i];
+            if (not shared.empty()) {
+                shared.draw(window);
+            } else if (tiled) {
+                window.setView(view);
+                window.draw(tiled_buffer);
+                // the HUD stays put, however the canvas is panned and zoomed
+                window.setView(window.getDefaultView());
+            } else {
+                // only the triangles added since last frame need adding to the buffer
+                for (const TriangleShape& triangle : changes.triangles) {
+                    append_triangle(render_buffer, triangle);
+                }
+                render_buffer_version = changes.version;
+                window.draw(render_buffer);
             }
+            // draw the background silhouette last, over the top of the triangles
+            // Drawing::Shapes shapes = drawing->get_shapes();
+            // sf::VertexArray silhouette(sf::LinesStrip, shapes.silhouette.size() + 1);
+            // for (std::size_t i = 0; i < shapes.silhouette.size() + 1; i++) {
+            //     std::size_t j = i % shapes.silhouette.size();
+            //     silhouette[i].position = sf::Vector2f(shapes.silhouette[j].x * SCALE, shapes.silhouette[j].y * SCALE);
+            //     // default draw colour appears to be white anyway...
+            //     // silhouette[i].color = sf::Color::White;
+            // }
+            // window.draw(silhouette);
+        }
 
-            window.draw(triangle);
-            drawn++;
+        if (show_hud) {
+            TRIANGBERG_TRACE_ZONE("hud");
+            hud.draw(window, figures);
         }
-        // draw the background silhouette last, over the top of the triangles
-        // sf::VertexArray silhouette(sf::LinesStrip, shapes.silhouette.size() + 1);
-        // for (std::size_t i = 0; i < shapes.silhouette.size() + 1; i++) {
-        //     std::size_t j = i % shapes.silhouette.size();
-        //     silhouette[i].position = sf::Vector2f(shapes.silhouette[j].x * SCALE, shapes.silhouette[j].y * SCALE);
-        //     // default draw colour appears to be white anyway...
-        //     // silhouette[i].color = sf::Color::White;
-        // }
-        // window.draw(silhouette);
 
         // end the current frame
+        TRIANGBERG_TRACE_ZONE("display");
         window.display();
     }
 
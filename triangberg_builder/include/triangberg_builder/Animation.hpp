@@ -0,0 +1,212 @@
+/**
+ * @file
+ * Renders the viewer's animation offline, as a stream of uncompressed video
+ * frames.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_ANIMATION_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_ANIMATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <memory_resource>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief The parameters of one frame of the animation
+     */
+    struct AnimationFrame {
+        Degrees angle; // branch angle
+        Percentage p; // branch point
+        Degrees base_angle; // rotation of the initial triangle
+    };
+
+    /**
+     * @brief The schedule the viewer sweeps its drawings' parameters through,
+     * one frame at a time
+     * @details The branch angle sweeps back and forth between 0.1° and
+     * 119.9° in steps of 0.1°, with the initial triangle turning against it
+     * at three quarters of the speed. Each time the angle turns around, the
+     * branch point moves on by 1%, itself sweeping back and forth between 1%
+     * and 99%.
+     */
+    class Sweep {
+    public:
+        Sweep();
+
+        /**
+         * @returns the current frame's parameters, moving on to the next frame
+         */
+        AnimationFrame next();
+
+    private:
+        Degrees _angle;
+        Percentage _p;
+        Degrees _base_angle;
+        Degrees _angle_delta;
+        Percentage _p_delta;
+    };
+
+    /**
+     * @brief An 8-bit RGB image, stored row by row with 3 bytes per pixel
+     */
+    struct Image {
+        std::size_t width;
+        std::size_t height;
+        std::vector<std::uint8_t> pixels;
+    };
+
+    /**
+     * @brief Settings for render_animation()
+     */
+    struct AnimationSettings {
+        std::size_t first_frame = 0; // how far into the sweep to start
+        std::size_t frames; // how many frames to render
+        Unit scale = 1; // pixels per unit, with the viewer's 800x600 screen at 1
+        std::size_t max_triangles = 10000; // most triangles to build in any one frame
+        std::size_t threads = 0; // how many threads to render with, or 0 for one per hardware thread
+    };
+
+    /**
+     * @brief Something that rendered frames are written out to, in order
+     */
+    class FrameSink {
+    public:
+        virtual ~FrameSink() = default;
+
+        /**
+         * @brief Called once for each frame, in order
+         */
+        virtual void write(const Image& frame) = 0;
+
+        /**
+         * @brief Called once after the last frame
+         */
+        virtual void finish() {}
+    };
+
+    /**
+     * @brief Writes frames as an uncompressed YUV4MPEG2 video stream, which
+     * most video tools (e.g. `ffmpeg -i -`) can read straight from a pipe
+     * @details Frames are converted to full-range BT.601 YCbCr, with the
+     * colour planes at half resolution (4:2:0). The stream header is written
+     * along with the first frame, as that's when the size is known.
+     */
+    class Y4mSink : public FrameSink {
+    public:
+        /**
+         * @param stream binary stream to write to, which must outlive this
+         * sink
+         * @param fps frame rate to label the video with
+         */
+        explicit Y4mSink(std::ostream& stream, std::size_t fps = 60);
+
+        void write(const Image& frame) override;
+
+        void finish() override;
+
+    private:
+        std::ostream& _stream;
+        std::size_t _fps;
+        bool _started;
+        std::vector<std::uint8_t> _planes; // reused between frames
+    };
+
+    /**
+     * @brief Writes each frame to its own binary PPM image, numbered in order
+     * as `frame_000000.ppm`, `frame_000001.ppm` and so on
+     */
+    class PpmSequenceSink : public FrameSink {
+    public:
+        /**
+         * @param directory where to write the images, which must exist
+         */
+        explicit PpmSequenceSink(std::filesystem::path directory);
+
+        void write(const Image& frame) override;
+
+    private:
+        std::filesystem::path _directory;
+        std::size_t _next;
+    };
+
+    /**
+     * @brief Builds a frame's Drawing the same way the viewer does
+     * @details The Drawing is grown to completion (or to max_triangles) on
+     * an 800x600 screen.
+     * @param resource memory resource for the Drawing to allocate from
+     */
+    Drawing build_frame(
+        const AnimationFrame& frame,
+        std::size_t max_triangles = 10000,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    );
+
+    /**
+     * @brief Builds many frames' Drawings at once, the same as build_frame()
+     * builds each
+     * @details The frames are shared out between threads as they become
+     * free, rather than in fixed runs, as some frames take many times longer
+     * to build than others. The calling thread builds its share too.
+     * @param frames parameters of each frame to build
+     * @param max_triangles most triangles to build in any one frame
+     * @param threads how many threads to build with, or 0 for one per
+     * hardware thread
+     * @param resource memory resource for the Drawings to allocate from,
+     * which must be thread-safe
+     * @returns one Drawing per frame, in the same order
+     * @note The Drawings built don't depend on the number of threads.
+     * @note If building any frame throws, no more are started, and the
+     * exception is rethrown from here once every thread has stopped.
+     */
+    std::vector<Drawing> build_many(
+        std::span<const AnimationFrame> frames,
+        std::size_t max_triangles = 10000,
+        std::size_t threads = 0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+    );
+
+    /**
+     * @brief Draws a frame's Drawing the same way the viewer does
+     * @details Each frame's Drawing is built with build_frame(), then its
+     * triangles are drawn in the order added over a black background, shaded
+     * from red to green to blue between their corners.
+     */
+    Image render_frame(const AnimationFrame& frame, Unit scale = 1, std::size_t max_triangles = 10000);
+
+    /**
+     * @brief Renders frames of the viewer's Sweep, writing them out to sink
+     * in order
+     * @details Frames are built and rasterised on worker threads, several at
+     * once, while the calling thread writes finished frames out. Frames that
+     * finish out of order wait in a reorder buffer until those before them
+     * are written, and workers don't start frames too far ahead of the
+     * writer, so at most a few frames per thread are ever held in memory.
+     * @note The output doesn't depend on the number of threads.
+     * @note If rendering a frame or writing one to the sink throws, the
+     * rest are abandoned, and the exception is rethrown from here without
+     * finishing the sink.
+     */
+    void render_animation(const AnimationSettings& settings, FrameSink& sink);
+}
+
+#endif // include guard
@@ -18,13 +18,22 @@
 #define COM_SAXBOPHONE_TRIANGBERG_DRAWING_HPP
 
 #include <cstddef>
+#include <cstdint>
 
+#include <chrono>
 #include <functional>
+#include <future>
 #include <memory>
+#include <memory_resource>
+#include <span>
+#include <stop_token>
 #include <vector>
 
 #include <triangberg_builder/types.hpp>
+#include <triangberg_builder/geometry.hpp>
 #include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
 
 namespace com::saxbophone::triangberg {
     /**
@@ -43,6 +52,87 @@ namespace com::saxbophone::triangberg {
             std::vector<Shape> triangles; // all the triangles in the drawing
         };
 
+        /**
+         * @brief What has been added to a Drawing since an earlier version of
+         * it, as returned by changes_since()
+         * @note There's no outline in here, as get_shapes() doesn't work
+         * out the silhouette yet either.
+         */
+        struct Changes {
+            std::size_t version; // the version these changes bring the caller up to, to ask from next time
+            TriangleStore::Snapshot triangles; // those added since the version asked about, in the order added
+        };
+
+        /**
+         * @brief The outcome of growing a Drawing by more than one triangle at
+         * a time
+         */
+        struct Growth {
+            std::size_t added; // how many triangles were added
+            bool complete; // whether the drawing is now complete
+        };
+
+        /**
+         * @brief Running totals of what happened to every pair of vertices
+         * tried as the first edge of a new triangle
+         * @note Cheap enough to keep track of all the time.
+         */
+        struct Stats {
+            std::size_t pairs_tried; // the sum of all of the below
+            std::size_t rejected_ineligible; // no room left around a vertex
+            std::size_t rejected_shared; // vertices already share a triangle
+            std::size_t rejected_size; // outside the edge-length bounds
+            std::size_t rejected_off_screen;
+            std::size_t rejected_covered; // inside an area already filled, going by a coarse grid
+            std::size_t rejected_intersecting;
+            std::size_t candidates; // passed every test
+        };
+
+        /**
+         * @brief Scoring function used to choose between candidate triangles
+         * @details Is passed the corners of a candidate triangle and should
+         * return its score. The candidate with the lowest score is added next.
+         * @note Must depend only on the candidate's corners (and not, say, on
+         * the rest of the Drawing), because each candidate is only scored once.
+         */
+        typedef std::function<Unit(const TriangleShape&)> Scorer;
+
+        /**
+         * @brief Settings for beam_search()
+         */
+        struct BeamSearch {
+            std::size_t width; // how many of the best drawings to keep after each step
+            std::size_t branching; // how many candidate triangles to try adding to each drawing, per step
+            std::size_t steps; // how many triangles to add to each drawing, at most
+            // score of a whole drawing, the lowest of which are kept
+            // NOTE: called from several threads at once, so must be safe to do so
+            std::function<Unit(const Drawing&)> score;
+            std::size_t threads = 0; // how many threads to search with, or 0 for one per hardware thread
+        };
+
+        /**
+         * @brief Where and how to start one tree of a forest, the same as for
+         * the Drawing constructor
+         */
+        struct Seed {
+            Point origin;
+            Unit size;
+            Degrees rotation;
+            EdgeID branch_edge;
+            Percentage branch_point;
+            Degrees branch_angle;
+        };
+
+        /**
+         * @brief Settings for grow_forest()
+         */
+        struct Forest {
+            std::vector<Seed> seeds; // initial and branched triangles of which mustn't overlap each other
+            Vector screen_size;
+            std::size_t max_triangles = 10000; // most triangles to grow in any one tree
+            std::size_t threads = 0; // how many threads to grow with, or 0 for one per hardware thread
+        };
+
         /**
          * @brief Constructs new Drawing object with given parameters
          * @param origin x/y centre of initial triangle in the drawing
@@ -58,6 +148,13 @@ namespace com::saxbophone::triangberg {
          * @param branch_angle angle between branch edge and first edge of new
          * triangle
          * @note branch_angle range is `0° < x < 120°`
+         * @param screen_size size of the area to fill with triangles
+         * @param resource memory resource that all of the Drawing's internal
+         * bookkeeping is allocated from
+         * @note resource must outlive the Drawing. Since a Drawing frees
+         * everything it allocated when it is destroyed, a monotonic arena such
+         * as `std::pmr::monotonic_buffer_resource` can be used and released in
+         * one go once the Drawing is finished with (e.g. once per frame).
          * @todo Add branch size (size of branched triangle) --missed out.
          */
         Drawing(
@@ -67,11 +164,124 @@ namespace com::saxbophone::triangberg {
             EdgeID branch_edge,
             Percentage branch_point,
             Degrees branch_angle,
-            Vector screen_size
+            Vector screen_size,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+        );
+
+        /**
+         * @brief Constructs a Drawing which carries on growing from a set of
+         * existing triangles, instead of from a single initial triangle
+         * @details Corners which are exactly equal are treated as the same
+         * vertex, so triangles which were joined in the Drawing they came from
+         * stay joined in this one. The seed triangles are the first ones in
+         * the new Drawing's snapshot().
+         * @param seeds triangles to start from, which must not overlap
+         * @param screen_size size of the area to fill with triangles
+         * @param resource memory resource that all of the Drawing's internal
+         * bookkeeping is allocated from
+         */
+        Drawing(
+            std::span<const TriangleShape> seeds,
+            Vector screen_size,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()
         );
 
+        /**
+         * @brief Takes over another Drawing's triangles and settings, leaving
+         * it unusable except to be destroyed or assigned to
+         */
+        Drawing(Drawing&& other) noexcept;
+
+        Drawing& operator=(Drawing&& other) noexcept;
+
         ~Drawing();
 
+        /**
+         * @brief Makes a copy of this Drawing, which can be grown separately
+         * @details The copy shares all of its state with this Drawing until
+         * either of them is grown, so forking takes `O(1)` time regardless of
+         * how many triangles have been added, besides `O(log n)` to share the
+         * triangles readers can see. Growing either one afterwards only copies
+         * the parts of that state which it changes: a small table of chunks,
+         * then a chunk of triangles or vertices at a time, each the first time
+         * it's changed.
+         * @note The copy allocates from the same memory resource as this
+         * Drawing, which must therefore be thread-safe if the two are grown
+         * on different threads.
+         * @warning Not safe to call while this Drawing is being grown.
+         */
+        Drawing fork() const;
+
+        /**
+         * @brief Searches for the best ways to grow a Drawing, by growing
+         * several forks of it at once
+         * @details Each step, every drawing kept so far is forked once for
+         * each of the first `branching` candidate triangles it could add next
+         * (or grown as normal, if not yet started), then only the `width`
+         * drawings with the lowest scores are kept. Drawings which are
+         * complete are kept as they are, still competing on score. Forks
+         * are grown and scored across `threads` threads.
+         * @details Ties are broken in favour of the drawing found first, so
+         * the result doesn't depend on how many threads are used.
+         * @param start drawing to search from, which is forked, not grown
+         * @param search settings of the search
+         * @returns up to `width` drawings, lowest score first
+         * @note As well as being safe to call from several threads, the score
+         * function must only read the drawing it's given. Anything it throws
+         * is rethrown from here, once every thread has stopped.
+         */
+        static std::vector<Drawing> beam_search(const Drawing& start, const BeamSearch& search);
+
+        /**
+         * @brief Grows several Drawings on one screen at once, each from its
+         * own seed, without any of them overlapping
+         * @details The trees grow in rounds, each adding up to one triangle
+         * per round. First, every tree finds its next triangle in parallel,
+         * against all the triangles there were at the start of the round.
+         * Then they're added one tree at a time, in seed order, with each
+         * checked again against those added before it that round. The rare
+         * triangle that now overlaps one is searched for again on the spot.
+         * So the result is exactly as if the trees took turns in seed order,
+         * adding one triangle each, and doesn't depend on how many threads are
+         * used.
+         * @param forest settings of the forest
+         * @param resource memory resource that all of the Drawings' internal
+         * bookkeeping is allocated from, which must be thread-safe
+         * @returns one Drawing per seed, in the same order
+         * @note Each tree knows about every other tree's triangles, so any
+         * that reached max_triangles can carry on being grown afterwards
+         * without overlapping the others.
+         */
+        static std::vector<Drawing> grow_forest(
+            const Forest& forest,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+        );
+
+        /**
+         * @brief Moves the area this Drawing fills with triangles
+         * @details By default this is the area from `{0, 0}` to `screen_size`.
+         * New triangles must lie at least partly inside it.
+         * @param top_left top-left corner of the area
+         * @param size size of the area
+         * @note Takes `O(n)` time for a Drawing of `n` triangles, as the
+         * coverage grid has to be redone for the new area.
+         */
+        void set_bounds(Point top_left, Vector size);
+
+        /**
+         * @brief Limits how big or small new triangles can be
+         * @details Setting a finite maximum also means only pairs of vertices
+         * at most that far apart are ever considered for new triangles, which
+         * are found with a spatial grid instead of by trying every pair. This
+         * makes each step roughly `O(V·k)` instead of `O(V²)`, for `V` vertices
+         * with about `k` neighbours in range each.
+         * @param min shortest allowed edge length of a new triangle
+         * @param max longest allowed edge length of a new triangle, which can
+         * be infinity (the default) for no limit
+         * @note Doesn't affect the initial or branched triangles.
+         */
+        void set_edge_length_bounds(Unit min, Unit max);
+
         /**
          * @returns whether this Drawing is complete (i.e. no more triangles
          * can be added to it)
@@ -91,15 +301,161 @@ namespace com::saxbophone::triangberg {
             std::function<std::size_t(std::size_t)> segment_picker
         );
 
+        /**
+         * @brief Sets the scoring function used to choose which candidate
+         * triangle to add next
+         * @details By default (or if an empty Scorer is given), the first
+         * candidate found is added. With a Scorer set, all valid candidates are
+         * kept in a priority queue which is updated incrementally as triangles
+         * are added, so picking the best one costs `O(log n)` per triangle
+         * rather than a rescan of every candidate.
+         * @note Ties are broken in favour of the candidate found first.
+         */
+        void set_scorer(Scorer scorer);
+
+        /**
+         * @brief Adds up to max_count triangles to the Drawing, stopping early
+         * if it becomes complete
+         * @details Equivalent to calling add_triangle() repeatedly, but without
+         * the per-call overhead.
+         * @returns how many triangles were added and whether the Drawing is
+         * now complete
+         */
+        Growth add_triangles(std::size_t max_count);
+
+        /**
+         * @brief Keeps adding triangles to the Drawing until either it is
+         * complete or the deadline has passed
+         * @details The deadline is also checked every few hundred pairs of
+         * vertices tried while searching for the next triangle. If it passes
+         * mid-search, the search is paused, and the next call carries on
+         * exactly where it stopped (unless the Drawing is changed some other
+         * way first). So a Drawing can be grown a bounded slice of work at a
+         * time, e.g. once per frame, however big it gets, and still end up
+         * the same as if it were grown in one go.
+         * @note This can overrun the deadline by the time taken to validate
+         * a batch of candidates, or to add a triangle once one is found.
+         * @returns how many triangles were added and whether the Drawing is
+         * now complete
+         */
+        Growth grow_until(std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * @brief Runs tasks somewhere other than the calling thread, such as
+         * on a thread pool, or each on a thread of its own with
+         * `[](auto task) { std::thread(std::move(task)).detach(); }`
+         */
+        typedef std::function<void(std::function<void()>)> Executor;
+
+        /**
+         * @brief Adds triangles to the Drawing on another thread until it is
+         * complete, max_count have been added, or it's stopped
+         * @details A stop request is also checked every few hundred pairs of
+         * vertices tried while searching for the next triangle, the same as
+         * grow_until()'s deadline is, so it's noticed well within a
+         * millisecond. The search is paused where it got to, so a stopped
+         * build can be carried on by any other means of growing the Drawing
+         * and end up the same as if it had never been stopped.
+         * @param executor what to run the build on
+         * @param stop for abandoning the build, e.g. once it's out of date
+         * @param max_count most triangles to add
+         * @returns how many triangles were added and whether the Drawing is
+         * now complete, once the build has finished or been stopped, or
+         * whatever was thrown whilst building (e.g. by the Scorer)
+         * @warning The Drawing mustn't be used in any way other than through
+         * snapshot(), version(), changes_since() or get_shapes(), nor moved
+         * or destroyed, until the result is ready.
+         */
+        std::future<Growth> build_async(
+            const Executor& executor,
+            std::stop_token stop,
+            std::size_t max_count = SIZE_MAX
+        );
+
         /**
          * @returns All the shapes that make up the drawing in its current state
          * @note This information can be used directly to draw a 2D visual of
          * this Drawing.
+         * @note Safe to call from another thread while triangles are being
+         * added, in which case it returns the triangles added so far.
          */
         Shapes get_shapes() const;
 
+        /**
+         * @returns A lock-free, allocation-free view of all the triangles
+         * added to the drawing so far
+         * @note Safe to call (and to read the result of) from any thread, even
+         * while another thread is calling add_triangle(). Triangles added after
+         * the snapshot was taken are not visible through it.
+         * @warning The snapshot must not outlive this Drawing.
+         */
+        TriangleStore::Snapshot snapshot() const;
+
+        /**
+         * @returns the version of the Drawing, which only ever goes up, by
+         * one for every triangle added
+         * @details It's how many triangles the Drawing has, so a fork starts
+         * off at the same version as the Drawing it was forked from.
+         * @note Safe to call from any thread, the same as snapshot().
+         */
+        std::size_t version() const;
+
+        /**
+         * @brief For keeping something in sync with a growing Drawing (such
+         * as a vertex buffer, an exporter or a cache) by handing it only what
+         * it hasn't seen yet
+         * @param version the version last brought up to, or 0 for everything
+         * @returns the triangles added since then, viewed in place without
+         * copying, along with the version that brings the caller up to
+         * @note Safe to call (and to read the result of) from any thread,
+         * the same as snapshot().
+         * @warning The result must not outlive this Drawing.
+         */
+        Changes changes_since(std::size_t version) const;
+
+        /**
+         * @returns how candidate triangles have fared since this Drawing was
+         * created
+         * @note Candidates are built in small batches, and the search stops
+         * as soon as one is found (unless a Scorer is set), so the rest of
+         * that batch isn't counted at all.
+         */
+        Stats get_stats() const;
+
+        /**
+         * @returns roughly what fraction of the screen area is filled with
+         * triangles
+         * @details Measured on a grid of 128x128 cells across the screen
+         * area, by how many of their centres are inside a triangle. The same
+         * grid is used to quickly reject candidate triangles whose insides
+         * are already filled, before they're tested exactly.
+         */
+        double get_coverage() const;
+
+        /**
+         * @returns every pair of intersecting triangles in the drawing, by
+         * their order in snapshot(), which is none unless the triangles it
+         * was seeded with intersect
+         * @see find_intersecting_triangles(std::span<const TriangleShape>)
+         */
+        std::vector<TrianglePair> find_intersecting_triangles() const;
+
     private:
+        // adds one triangle if possible before the deadline or a stop request, returning whether one was added
+        // NOTE: if either comes first, the search for it carries on from there next time
+        bool grow(
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+            const std::stop_token& stop = {}
+        );
+
         class Builder; // forward-declaration of helper class for implementation
+
+        Drawing(std::unique_ptr<Builder> builder, bool started, bool can_add_more);
+
+        // adds forks of this Drawing, one with each of the first limit triangles it could add next, to forks
+        // NOTE: may leave this Drawing moved-from
+        void branch(std::size_t limit, std::vector<Drawing>& forks);
+
         std::unique_ptr<Builder> _builder;
         bool _started;
         bool _can_add_more;
@@ -0,0 +1,179 @@
+/**
+ * @file
+ * A ring of finished frames in shared memory, for handing Drawings from a
+ * generator process to a viewer without serialising them.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_FRAME_RING_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_FRAME_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <optional>
+#include <span>
+#include <string>
+
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief One corner of a triangle in a FrameRing, with the colour it's
+     * shaded with
+     * @details Laid out the same as the usual position, colour and texture
+     * coordinate vertex of 2D graphics libraries (SFML's `sf::Vertex`, for
+     * one), so that a frame's vertices can be drawn straight out of shared
+     * memory. The texture coordinates are always zero.
+     */
+    struct FrameVertex {
+        float x;
+        float y;
+        std::uint8_t red;
+        std::uint8_t green;
+        std::uint8_t blue;
+        std::uint8_t alpha;
+        float texture_x;
+        float texture_y;
+    };
+
+    /**
+     * @brief A finished frame in a FrameRing, viewed in place in shared
+     * memory
+     */
+    struct RingFrame {
+        std::uint64_t number; // how many frames were written to the ring before this one
+        AnimationFrame parameters;
+        std::span<const FrameVertex> vertices; // three per triangle, in the order they were added
+    };
+
+    /**
+     * @brief Creates a ring of frame slots in POSIX shared memory, and writes
+     * finished frames into it for a FrameRingReader in another process
+     * @details There is exactly one writer and one reader per ring. They
+     * hand slots back and forth with a pair of atomic counters (of frames
+     * written and frames read), so neither ever waits on a lock, and each
+     * frame's triangles are written straight into their slot once and then
+     * read from the same memory. For several generator processes, give each
+     * its own ring.
+     * @note Only available on POSIX systems.
+     */
+    class FrameRingWriter {
+    public:
+        /**
+         * @param name name of the shared memory object to create, which
+         * should start with a `/`, replacing any that's already there
+         * @param slots how many frames the ring holds at once
+         * @param max_triangles most triangles any one frame can hold, with
+         * any more being left out
+         * @note Check is_open() afterwards to see if it worked.
+         */
+        explicit FrameRingWriter(std::string name, std::size_t slots = 4, std::size_t max_triangles = 10000);
+
+        FrameRingWriter(const FrameRingWriter&) = delete;
+
+        FrameRingWriter& operator=(const FrameRingWriter&) = delete;
+
+        /**
+         * @brief Tells the reader that no more frames are coming and removes
+         * the shared memory object's name
+         * @note A reader that's attached can still read whatever frames are
+         * left.
+         */
+        ~FrameRingWriter();
+
+        /**
+         * @returns whether the ring was created successfully
+         */
+        bool is_open() const;
+
+        /**
+         * @returns whether every slot holds a frame the reader hasn't
+         * finished with yet
+         */
+        bool is_full() const;
+
+        /**
+         * @brief Copies the Drawing's triangles into the next free slot and
+         * hands it to the reader
+         * @details Each triangle's corners are shaded red, green and blue in
+         * turn, the same as the viewer draws them.
+         * @returns whether it was written, which it isn't if the ring is full
+         */
+        bool write(const AnimationFrame& parameters, const Drawing& drawing);
+
+    private:
+        std::string _name;
+        void* _memory; // nullptr if not open
+        std::size_t _size;
+    };
+
+    /**
+     * @brief Attaches to a ring created by a FrameRingWriter, to read its
+     * frames in the order they were written
+     * @note Only available on POSIX systems.
+     */
+    class FrameRingReader {
+    public:
+        /**
+         * @param name name the ring was created with
+         * @note Check is_open() afterwards to see if it worked.
+         */
+        explicit FrameRingReader(const std::string& name);
+
+        FrameRingReader(const FrameRingReader&) = delete;
+
+        FrameRingReader& operator=(const FrameRingReader&) = delete;
+
+        ~FrameRingReader();
+
+        /**
+         * @returns whether the ring was attached to successfully
+         */
+        bool is_open() const;
+
+        /**
+         * @returns how many frames are waiting to be read
+         */
+        std::size_t available() const;
+
+        /**
+         * @returns the oldest frame not yet read, or nothing if there are
+         * none waiting
+         * @note A frame claiming more triangles than a slot can hold is cut
+         * short, rather than read past the end of its slot.
+         * @warning The frame's vertices are only valid until pop() is
+         * called, after which the writer can reuse its slot.
+         */
+        std::optional<RingFrame> peek() const;
+
+        /**
+         * @brief Finishes with the oldest frame, handing its slot back to the
+         * writer
+         */
+        void pop();
+
+        /**
+         * @returns whether the writer has gone, so that no more frames will
+         * arrive after those that are available
+         */
+        bool is_closed() const;
+
+    private:
+        void* _memory; // nullptr if not open
+        std::size_t _size;
+    };
+}
+
+#endif // include guard
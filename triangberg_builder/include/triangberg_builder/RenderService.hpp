@@ -0,0 +1,240 @@
+/**
+ * @file
+ * A local service which builds Drawings on request over a Unix domain socket,
+ * so that several programs can share one cache of them.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_RENDER_SERVICE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_RENDER_SERVICE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief Serves Drawings to other processes on the same machine over a
+     * Unix domain socket
+     * @details Each connection sends any number of fixed-size requests (see
+     * Request::encode()) and gets one response back for each, in order. A
+     * response is a status byte (0 for success, 1 for a malformed request,
+     * after which the connection is closed, or 2 if the Drawing couldn't be
+     * built, such as when there's not enough memory), then the length of the
+     * payload as a 64-bit unsigned integer, then the payload itself. All
+     * numbers are in the host's own byte order, as the socket is local.
+     * @details Requests are served by a pool of threads, each of which only
+     * takes a connection for as long as it takes to answer one request, so
+     * idle connections don't hold any up. Clients which stall for more than
+     * a few seconds partway through a request or response are disconnected.
+     * Finished
+     * responses are kept in a least-recently-used cache, and requests which
+     * arrive whilst an identical one is still being built just wait for
+     * that build instead of starting another.
+     * @note Only available on POSIX systems.
+     */
+    class RenderService {
+    public:
+        /**
+         * @brief What to send back for a request
+         */
+        enum class Format : std::uint8_t {
+            /**
+             * @brief The triangles themselves: their count as a 32-bit
+             * unsigned integer, then the x and y of each of their corners as
+             * doubles
+             */
+            GEOMETRY = 0,
+            /**
+             * @brief The triangles drawn into an image the size of the
+             * screen: its width and height as 32-bit unsigned integers, then
+             * one byte per pixel, row by row, which is 255 where a pixel's
+             * centre is inside any triangle and 0 elsewhere
+             */
+            RASTER = 1,
+        };
+
+        /**
+         * @brief The parameters of a Drawing, as for its constructor, plus
+         * what to send back for it
+         */
+        struct Request {
+            Point origin;
+            Unit size;
+            Degrees rotation;
+            EdgeID branch_edge;
+            Percentage branch_point;
+            Degrees branch_angle;
+            Vector screen_size;
+            std::uint32_t max_triangles; // stop growing after this many
+            Format format;
+
+            /**
+             * @brief Size in bytes of an encoded Request
+             */
+            static constexpr std::size_t ENCODED_SIZE = 4 + 4 + 8 * 8 + 8 + 4 + 4;
+
+            /**
+             * @returns this Request as sent over the socket: a 4-byte magic
+             * number, 1 byte each for protocol version and format, 2 bytes of
+             * padding, the origin, size, rotation, branch point, branch angle
+             * and screen size as doubles, then the branch edge as a 64-bit
+             * and the triangle limit as a 32-bit unsigned integer, then 4
+             * more bytes of padding
+             */
+            std::vector<std::uint8_t> encode() const;
+
+            /**
+             * @returns the Request encoded in the given bytes, or nothing if
+             * they aren't a valid Request
+             * @note Requests with a branch edge other than 0, 1 or 2, a
+             * screen bigger than 16384 pixels either way, or any other number
+             * which isn't finite or is bigger than a billion either way, are
+             * all invalid.
+             */
+            static std::optional<Request> decode(std::span<const std::uint8_t> bytes);
+        };
+
+        /**
+         * @brief A decoded RASTER payload
+         */
+        struct Raster {
+            std::uint32_t width;
+            std::uint32_t height;
+            std::vector<std::uint8_t> pixels;
+        };
+
+        /**
+         * @brief Starts serving on a new socket at the given path
+         * @param socket_path where to create the socket, replacing anything
+         * already there
+         * @param threads how many requests to serve at once, or 0 for one per
+         * hardware thread
+         * @param cache_size how many finished responses to keep for repeat
+         * requests, not counting those still being built, which are always
+         * shared with identical requests however many there are
+         * @note Check is_listening() afterwards to see if it worked.
+         */
+        RenderService(std::string socket_path, std::size_t threads = 0, std::size_t cache_size = 64);
+
+        RenderService(const RenderService&) = delete;
+
+        RenderService& operator=(const RenderService&) = delete;
+
+        /**
+         * @brief Stops serving, closing any open connections and removing the
+         * socket
+         */
+        ~RenderService();
+
+        /**
+         * @returns whether the socket was created successfully
+         */
+        bool is_listening() const;
+
+        /**
+         * @returns how many Drawings have actually been built, as opposed to
+         * being served from the cache or shared with an identical request
+         */
+        std::size_t builds() const;
+
+        /**
+         * @returns the payload of the response to the given Request, built
+         * directly without any service
+         */
+        static std::vector<std::uint8_t> render(const Request& request);
+
+        /**
+         * @brief Sends a Request to the service listening at the given path
+         * and waits for its response
+         * @returns the payload of the response, or nothing if the service
+         * couldn't be reached or the request failed
+         * @note Opens a new connection each time, for simplicity.
+         */
+        static std::optional<std::vector<std::uint8_t>> fetch(const std::string& socket_path, const Request& request);
+
+        /**
+         * @returns the triangles in a GEOMETRY payload, or nothing if it's
+         * malformed
+         */
+        static std::optional<std::vector<TriangleShape>> decode_geometry(std::span<const std::uint8_t> payload);
+
+        /**
+         * @returns the image in a RASTER payload, or nothing if it's malformed
+         */
+        static std::optional<Raster> decode_raster(std::span<const std::uint8_t> payload);
+
+    private:
+        typedef std::shared_ptr<const std::vector<std::uint8_t>> Payload;
+        typedef std::vector<std::uint8_t> Key; // an encoded Request
+
+        // a cached response
+        struct Entry {
+            Payload payload;
+            std::list<Key>::iterator recency; // where it is in _recency
+        };
+
+        // makes poll_connections() look again at which connections to wait on, or notice it's stopping
+        void wake_poller();
+
+        // accepts new connections, and hands those with a request waiting over to the workers
+        void poll_connections();
+
+        void work();
+
+        // answers the next request on the given connection, returning whether to keep it open for more
+        bool serve(int connection);
+
+        // gets the response from the cache, from an identical build in progress, or by building it
+        // returns nothing if it couldn't be built
+        Payload respond(const Request& request);
+
+        std::string _socket_path;
+        std::size_t _cache_size;
+        int _listener; // -1 if not listening
+        int _wake[2]; // pipe used to wake the accepting thread up to stop
+
+        mutable std::mutex _mutex;
+        std::condition_variable _connection_available;
+        std::deque<int> _connections; // with a request waiting, but not yet being served
+        std::set<int> _serving;
+        std::set<int> _idle; // waiting for their next request
+        std::map<Key, Entry> _cache; // only finished responses, so that evicting one never causes a second build
+        std::list<Key> _recency; // most recently used first
+        std::map<Key, std::shared_future<Payload>> _building; // responses being built, for identical requests to share
+        std::size_t _builds;
+        bool _stopping;
+        std::thread _poller;
+        std::vector<std::thread> _workers;
+    };
+}
+
+#endif // include guard
@@ -0,0 +1,187 @@
+/**
+ * @file
+ * Grows very large tiled drawings with bounded memory, by keeping finished
+ * tiles on disk and streaming them out as they're finished.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_STREAMING_CANVAS_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_STREAMING_CANVAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleSink.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+namespace com::saxbophone::triangberg {
+    namespace PRIVATE {
+        struct Tiling;
+    }
+
+    /**
+     * @brief Grows a fixed number of rings of tiles around the origin, exactly
+     * as a TiledCanvas would, streaming each tile out to a TriangleSink as
+     * soon as it and all of its neighbours have been grown
+     * @details Every tile's triangles are written to a spill file on disk as
+     * soon as it's grown, and only a limited number of tiles are kept in
+     * memory as well. Tiles which aren't in memory but are still needed (to
+     * grow or stream out a neighbour) are read back from the spill file, and
+     * tiles are forgotten entirely once they and all their neighbours have
+     * been streamed out. The spill file is written in growth order, which is
+     * ring by ring outwards, so neighbouring tiles are stored near each other.
+     * @details So, no matter how big the drawing gets, at most resident_limit
+     * tiles' triangles are in memory at once (besides those of the tile being
+     * grown), plus a few bytes of bookkeeping for each tile in the outermost
+     * couple of rings.
+     * @note Growth happens on the calling thread, one tile at a time.
+     */
+    class StreamingCanvas {
+    public:
+        /**
+         * @brief Prepares to grow a drawing, without growing any of it yet
+         * @details The drawing parameters are the same as for TiledCanvas.
+         * @param rings how many rings of tiles to grow around the origin tile
+         * @param sink where finished tiles are streamed out to, which must
+         * outlive this StreamingCanvas
+         * @param spill_path file to keep grown tiles in, which is replaced if
+         * it already exists and removed when this StreamingCanvas is destroyed
+         * @param resident_limit how many tiles' triangles to keep in memory
+         * @param tile_limit maximum number of triangles to grow in any one tile
+         */
+        StreamingCanvas(
+            Point origin,
+            Unit size,
+            Degrees rotation,
+            EdgeID branch_edge,
+            Percentage branch_point,
+            Degrees branch_angle,
+            Vector tile_size,
+            std::int64_t rings,
+            TriangleSink& sink,
+            std::filesystem::path spill_path,
+            std::size_t resident_limit = 16,
+            std::size_t tile_limit = 10000
+        );
+
+        StreamingCanvas(const StreamingCanvas&) = delete;
+
+        StreamingCanvas& operator=(const StreamingCanvas&) = delete;
+
+        /**
+         * @brief Removes the spill file
+         */
+        ~StreamingCanvas();
+
+        /**
+         * @brief Grows the next tile, then streams out any tiles which that
+         * has finished
+         * @details Once the last tile has been grown, the sink is finished.
+         * @returns whether there are any more tiles left to grow, which there
+         * aren't once has_failed()
+         */
+        bool grow_next();
+
+        /**
+         * @brief Grows and streams out every remaining tile
+         */
+        void grow_all();
+
+        /**
+         * @returns how many tiles have been grown so far
+         */
+        std::size_t tiles_grown() const;
+
+        /**
+         * @returns how many tiles have been streamed out to the sink so far
+         */
+        std::size_t tiles_streamed() const;
+
+        /**
+         * @returns how many tiles' triangles are currently held in memory
+         */
+        std::size_t resident_tiles() const;
+
+        /**
+         * @returns whether the spill file couldn't be created, written to or
+         * read back from, or the sink couldn't store a tile
+         * @note Once it has, nothing more is grown or streamed out and the
+         * sink is never finished, so that a half-written drawing can be told
+         * apart from a complete one.
+         */
+        bool has_failed() const;
+
+    private:
+        // a tile which has been grown but isn't yet finished with
+        struct Tile {
+            std::uint64_t offset; // where its triangles are in the spill file
+            std::uint64_t count; // how many triangles it has
+            bool streamed;
+        };
+
+        PRIVATE::Tiling tiling() const;
+
+        bool in_range(TiledCanvas::TileID id) const;
+
+        // the triangles of the given tile, from memory if possible, or none if it can't be read back
+        // NOTE: the returned reference is only valid until the next call
+        const std::vector<TriangleShape>& load(TiledCanvas::TileID id);
+
+        void keep_resident(TiledCanvas::TileID id, std::vector<TriangleShape> triangles);
+
+        void stream_out(TiledCanvas::TileID id);
+
+        // stops everything, as the spill file can't be relied upon
+        void fail();
+
+        // forgets about any of the given tile and its neighbours which are no longer needed
+        void forget_finished(TiledCanvas::TileID id, TiledCanvas::TileID latest);
+
+        Point _origin;
+        Unit _size;
+        Degrees _rotation;
+        EdgeID _branch_edge;
+        Percentage _branch_point;
+        Degrees _branch_angle;
+        Vector _tile_size;
+        std::size_t _tile_limit;
+        std::int64_t _rings;
+        TriangleSink& _sink;
+        std::filesystem::path _spill_path;
+        std::fstream _spill;
+        std::uint64_t _spill_size;
+        std::size_t _resident_limit;
+
+        std::map<TiledCanvas::TileID, Tile> _tiles; // only those still needed
+        std::map<TiledCanvas::TileID, std::vector<TriangleShape>> _resident;
+        std::list<TiledCanvas::TileID> _recency; // resident tiles, most recently used first
+        std::vector<TriangleShape> _loaded; // reused for tiles read back from the spill file
+        TiledCanvas::TileID _next; // next tile to grow
+        bool _done;
+        std::size_t _tiles_grown;
+        std::size_t _tiles_streamed;
+        bool _failed;
+    };
+}
+
+#endif // include guard
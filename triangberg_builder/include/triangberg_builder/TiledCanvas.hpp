@@ -0,0 +1,191 @@
+/**
+ * @file
+ * An effectively unbounded canvas which is split into tiles, each of which is
+ * only grown once some part of it is actually needed.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TILED_CANVAS_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TILED_CANVAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <compare>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+namespace com::saxbophone::triangberg {
+    namespace PRIVATE {
+        struct Tiling;
+    }
+
+    /**
+     * @brief A Drawing spread over a grid of tiles which are grown lazily, in
+     * the background, as parts of the canvas are requested
+     * @details The tile containing `origin` is grown just like a Drawing with
+     * the same parameters would be, but bounded by that tile. Every other tile
+     * is grown from the triangles of its already-grown neighbours, so
+     * triangles which cross a seam are shared with the tile on the other side
+     * of it and growth carries on seamlessly across tiles.
+     * @details To keep the result deterministic no matter which order tiles
+     * are requested in or how many threads grow them, tiles are always grown
+     * in order of distance (in rings) from the origin tile, and a tile only
+     * starts once all of its neighbours which come before it in that order
+     * are finished. Requesting a tile therefore also requests the tiles
+     * between it and the origin.
+     * @note Triangles are only ever shared with immediately neighbouring
+     * tiles, so no edge grown in any tile is allowed to be longer than half
+     * the tile's shorter side. tile_size should be several times larger than
+     * the initial triangle for the same reason.
+     */
+    class TiledCanvas {
+    public:
+        /**
+         * @brief Grid coördinates of a tile, with `{0, 0}` being the tile
+         * containing the origin
+         */
+        struct TileID {
+            std::int64_t x;
+            std::int64_t y;
+
+            auto operator<=>(const TileID&) const = default;
+        };
+
+        /**
+         * @brief Constructs a new TiledCanvas with nothing grown on it yet
+         * @details The drawing parameters are the same as for Drawing.
+         * @param tile_size size of each tile
+         * @param threads number of background threads to grow tiles on, or 0
+         * to use one per hardware thread
+         * @param tile_limit maximum number of triangles to grow in any one
+         * tile
+         */
+        TiledCanvas(
+            Point origin,
+            Unit size,
+            Degrees rotation,
+            EdgeID branch_edge,
+            Percentage branch_point,
+            Degrees branch_angle,
+            Vector tile_size,
+            std::size_t threads = 0,
+            std::size_t tile_limit = 10000
+        );
+
+        TiledCanvas(const TiledCanvas&) = delete;
+
+        TiledCanvas& operator=(const TiledCanvas&) = delete;
+
+        /**
+         * @brief Stops the background threads, abandoning any tiles which have
+         * been requested but not yet started
+         */
+        ~TiledCanvas();
+
+        /**
+         * @returns the ID of the tile containing the given point
+         */
+        TileID tile_at(Point point) const;
+
+        /**
+         * @brief Starts growing (in the background) every tile needed to show
+         * the given area of the canvas, if not already grown or growing
+         * @note Returns immediately.
+         */
+        void request(Point top_left, Vector size);
+
+        /**
+         * @returns whether every tile needed to show the given area has been
+         * grown
+         */
+        bool is_ready(Point top_left, Vector size) const;
+
+        /**
+         * @brief Requests the given area and blocks until it is ready
+         * @note If growing any tile needed throws, this rethrows it. Tiles
+         * grown from a tile that failed fail with it, with the same exception.
+         */
+        void wait(Point top_left, Vector size);
+
+        /**
+         * @returns the triangles which have been grown so far in or around
+         * the given area
+         * @note Triangles are returned in the order their tiles were grown.
+         * @note Tiles which aren't ready yet are skipped, so this can be used
+         * to show a partially-grown area whilst the rest is being grown.
+         * @note Rethrows whatever was thrown growing any tile needed which has
+         * failed, which such tiles count as ready for.
+         */
+        std::vector<TriangleShape> get_triangles(Point top_left, Vector size) const;
+
+        /**
+         * @returns how many tiles have been grown so far, not counting any
+         * which failed
+         */
+        std::size_t tiles_grown() const;
+
+    private:
+        struct Tile {
+            std::vector<TileID> dependencies; // tiles this one is grown from
+            std::vector<TileID> dependents; // unfinished tiles waiting for this one
+            std::size_t waiting_on = 0; // how many dependencies are unfinished
+            bool done = false;
+            std::vector<TriangleShape> triangles; // only those created in this tile
+            std::exception_ptr failure; // what was thrown growing it or one of its dependencies, if anything
+        };
+
+        // all tiles which must be shown to draw the given area
+        std::vector<TileID> tiles_for(Point top_left, Vector size) const;
+
+        PRIVATE::Tiling tiling() const;
+
+        // schedules the given tile and all it depends upon --lock must be held
+        void schedule(TileID id);
+
+        // grows the given tile, whose dependencies must all be done
+        std::vector<TriangleShape> grow(TileID id, const std::vector<const Tile*>& dependencies) const;
+
+        void work();
+
+        Point _origin;
+        Unit _size;
+        Degrees _rotation;
+        EdgeID _branch_edge;
+        Percentage _branch_point;
+        Degrees _branch_angle;
+        Vector _tile_size;
+        std::size_t _tile_limit;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _work_available;
+        std::condition_variable _tile_done;
+        std::map<TileID, Tile> _tiles;
+        std::deque<TileID> _queue; // tiles whose dependencies are all done
+        std::size_t _tiles_grown;
+        bool _stopping;
+        std::vector<std::thread> _workers;
+    };
+}
+
+#endif // include guard
@@ -0,0 +1,35 @@
+/**
+ * @file
+ * Plain-data representation of a single triangle in a Drawing.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_SHAPE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_SHAPE_HPP
+
+#include <array>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief The three corner Points of a triangle, in the order they were
+     * constructed
+     * @note Unlike Drawing::Shape, this is fixed-size and can be copied around
+     * without touching the heap.
+     */
+    typedef std::array<Point, 3> TriangleShape;
+}
+
+#endif // include guard
@@ -0,0 +1,169 @@
+/**
+ * @file
+ * Destinations which triangles can be streamed out to as they are grown,
+ * rather than collected up in memory.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_SINK_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_SINK_HPP
+
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/geometry.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief A finished tile of a tiled drawing, as handed to a TriangleSink
+     * @warning The spans are only valid for the duration of the call they
+     * are passed to.
+     */
+    struct StreamedTile {
+        TiledCanvas::TileID id;
+        Point corner; // top-left corner
+        Vector size;
+        std::span<const TriangleShape> triangles; // only those grown in this tile
+        /**
+         * @brief The triangles of this tile and all its neighbours, which
+         * between them are all the triangles which could cover any of it
+         */
+        std::span<const TriangleShape> surroundings;
+    };
+
+    /**
+     * @brief Something that finished tiles are streamed out to, one at a time
+     */
+    class TriangleSink {
+    public:
+        virtual ~TriangleSink() = default;
+
+        /**
+         * @brief Called once for each tile, once it is finished
+         */
+        virtual void write(const StreamedTile& tile) = 0;
+
+        /**
+         * @brief Called once after the last tile
+         */
+        virtual void finish() {}
+
+        /**
+         * @returns whether anything written so far couldn't be stored, such
+         * as when the disk is full or the destination can't be written to
+         */
+        virtual bool has_failed() const {
+            return false;
+        }
+    };
+
+    /**
+     * @brief Writes each tile's own triangles to a compact binary file
+     * @details For each tile, in the order written: its x and y as 64-bit
+     * signed integers, how many triangles it has as a 64-bit unsigned
+     * integer, then the x and y of each triangle's corners as doubles. All
+     * numbers are in the host's byte order.
+     */
+    class BinarySink : public TriangleSink {
+    public:
+        explicit BinarySink(const std::filesystem::path& path);
+
+        void write(const StreamedTile& tile) override;
+
+        void finish() override;
+
+        bool has_failed() const override;
+
+        /**
+         * @param path file written by a BinarySink
+         * @param intersecting if given, filled with every pair of the
+         * triangles read that intersect, which for a file written from a
+         * drawing should be none, so that a corrupted or tampered-with file
+         * can be told apart
+         * @returns every triangle in the file, in order, stopping before the
+         * first tile which is cut short or whose triangle count is more than
+         * the rest of the file could hold
+         */
+        static std::vector<TriangleShape> read(
+            const std::filesystem::path& path,
+            std::vector<TrianglePair>* intersecting = nullptr
+        );
+
+    private:
+        std::ofstream _file;
+    };
+
+    /**
+     * @brief Writes each tile's own triangles to an SVG image, as a group of
+     * polygons per tile
+     */
+    class SvgSink : public TriangleSink {
+    public:
+        /**
+         * @param path file to write to
+         * @param top_left,size area of the drawing to show in the image
+         */
+        SvgSink(const std::filesystem::path& path, Point top_left, Vector size);
+
+        /**
+         * @brief Finishes the image off, if not already
+         */
+        ~SvgSink();
+
+        void write(const StreamedTile& tile) override;
+
+        void finish() override;
+
+        bool has_failed() const override;
+
+    private:
+        std::ofstream _file;
+        bool _finished;
+    };
+
+    /**
+     * @brief Draws each tile into its own 8-bit greyscale image, as a binary
+     * PGM file named `tile_<x>_<y>.pgm`
+     * @details Pixels are 255 where their centre is inside a triangle and 0
+     * elsewhere. Laid side by side, the images make up the whole drawing.
+     */
+    class RasterTileSink : public TriangleSink {
+    public:
+        /**
+         * @param directory where to write the images, which must exist
+         * @param scale how many pixels to use per unit of the drawing
+         */
+        explicit RasterTileSink(std::filesystem::path directory, Unit scale = 1);
+
+        void write(const StreamedTile& tile) override;
+
+        bool has_failed() const override;
+
+    private:
+        std::filesystem::path _directory;
+        Unit _scale;
+        std::vector<std::uint8_t> _pixels; // reused between tiles
+        bool _failed;
+    };
+}
+
+#endif // include guard
@@ -0,0 +1,192 @@
+/**
+ * @file
+ * Append-only storage for the triangles of a Drawing, which can be read from
+ * other threads while it is still being appended to.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_STORE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TRIANGLE_STORE_HPP
+
+#include <cstddef>
+
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+
+#include <triangberg_builder/TriangleShape.hpp>
+
+namespace com::saxbophone::triangberg {
+    /**
+     * @brief Append-only container of TriangleShapes with a single writer and
+     * any number of concurrent readers
+     * @details Triangles are stored in chunks of geometrically increasing
+     * size which are never moved or freed until the store itself is destroyed,
+     * so a triangle's address never changes once it has been appended. The
+     * number of triangles is published atomically after each append (acting
+     * as an RCU-style epoch), so a reader which takes a Snapshot sees every
+     * triangle appended up to that point and nothing partially-written.
+     * @note A store can also start off sharing all the triangles of another,
+     * in which case the two share their storage for them too.
+     * @note Only one thread may call push_back() at a time. size() and
+     * snapshot() may be called from any thread at any time, and reading a
+     * Snapshot never locks or allocates.
+     * @warning A Snapshot must not outlive the store it was taken from.
+     */
+    class TriangleStore {
+    public:
+        /**
+         * @brief A consistent, read-only view of the triangles of a
+         * TriangleStore published by the time it was taken, or of those from
+         * some point onwards
+         */
+        class Snapshot {
+        public:
+            class Iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef TriangleShape value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const TriangleShape* pointer;
+                typedef const TriangleShape& reference;
+
+                Iterator() = default;
+
+                reference operator*() const;
+                pointer operator->() const;
+                Iterator& operator++();
+                Iterator operator++(int);
+                bool operator==(const Iterator&) const = default;
+
+            private:
+                friend Snapshot;
+
+                Iterator(const TriangleStore* store, std::size_t index);
+
+                const TriangleStore* _store = nullptr;
+                std::size_t _index = 0;
+            };
+
+            /**
+             * @brief Constructs an empty Snapshot not associated with any store
+             */
+            Snapshot() = default;
+
+            /**
+             * @returns number of triangles visible in this Snapshot
+             */
+            std::size_t size() const;
+
+            /**
+             * @param first position in this Snapshot of the first triangle to
+             * include
+             * @returns a view of this Snapshot's triangles from first onwards,
+             * which is empty if first is past the end
+             * @note Nothing is copied, so this takes constant time.
+             */
+            Snapshot since(std::size_t first) const;
+
+            /**
+             * @returns whether this Snapshot contains no triangles
+             */
+            bool empty() const;
+
+            /**
+             * @param index position of triangle to get, in range `0..size()-1`
+             * @returns the triangle at the given position
+             */
+            const TriangleShape& operator[](std::size_t index) const;
+
+            Iterator begin() const;
+
+            Iterator end() const;
+
+        private:
+            friend TriangleStore;
+
+            Snapshot(const TriangleStore* store, std::size_t first, std::size_t size);
+
+            const TriangleStore* _store = nullptr;
+            std::size_t _first = 0; // position in the store of the first triangle visible
+            std::size_t _size = 0;
+        };
+
+        /**
+         * @param resource memory resource to allocate chunks from, which must
+         * outlive the store
+         */
+        explicit TriangleStore(
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+        );
+
+        /**
+         * @brief Makes a store which starts off with all the triangles in
+         * another, sharing their storage with it rather than copying them
+         * @details Taking only O(log n) time and no memory of its own, this
+         * is for when a Drawing is forked. The first triangle appended to the
+         * new store copies whatever triangles it shares in the chunk that
+         * it's appended to, which is at most half of them.
+         * @param base store to share triangles with, which may be destroyed
+         * before the new store is
+         * @param resource memory resource to allocate chunks from, which must
+         * outlive the store
+         * @warning Not safe to call while base is being appended to.
+         */
+        TriangleStore(const TriangleStore& base, std::pmr::memory_resource* resource);
+
+        TriangleStore(const TriangleStore&) = delete;
+
+        TriangleStore& operator=(const TriangleStore&) = delete;
+
+        ~TriangleStore();
+
+        /**
+         * @brief Appends a triangle and publishes it to readers
+         * @warning Not safe to call from more than one thread at a time
+         */
+        void push_back(const TriangleShape& triangle);
+
+        /**
+         * @returns number of triangles published so far
+         */
+        std::size_t size() const;
+
+        /**
+         * @returns a view of every triangle published so far
+         */
+        Snapshot snapshot() const;
+
+    private:
+        // size of the first chunk --each chunk after it is twice as big as the last
+        static constexpr std::size_t FIRST_CHUNK_SIZE = 64;
+        // enough chunks to exhaust any realistic address space
+        static constexpr std::size_t MAX_CHUNKS = 48;
+
+        // finds the address of the triangle at index, which must be published
+        const TriangleShape& at(std::size_t index) const;
+
+        std::pmr::memory_resource* _resource;
+        std::array<std::atomic<TriangleShape*>, MAX_CHUNKS> _chunks;
+        // keeps each chunk alive for as long as any store it's shared with is
+        std::array<std::shared_ptr<TriangleShape>, MAX_CHUNKS> _owners;
+        // a chunk only partly shared with the store this one was made from, which must be copied to append to
+        std::size_t _shared_chunk;
+        // the original of that chunk once it has been copied, kept for readers which may still be using it
+        std::shared_ptr<TriangleShape> _copied_from;
+        std::atomic<std::size_t> _size;
+    };
+}
+
+#endif // include guard
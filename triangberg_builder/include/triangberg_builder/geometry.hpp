@@ -17,11 +17,15 @@
 #ifndef COM_SAXBOPHONE_TRIANGBERG_GEOMETRY_HPP
 #define COM_SAXBOPHONE_TRIANGBERG_GEOMETRY_HPP
 
+#include <cstddef>
+
+#include <span>
 #include <vector>
 
 #include <triangberg_builder/types.hpp>
 #include <triangberg_builder/Line.hpp>
 #include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
 #include <triangberg_builder/Vector.hpp>
 
 namespace com::saxbophone::triangberg {
@@ -60,6 +64,28 @@ namespace com::saxbophone::triangberg {
      */
     Point subtend_point_from_vector(Point origin, Vector v, Radians theta);
 
+    /**
+     * @brief Batched form of subtend_point_from_vector(), for many origins and
+     * Vectors which are all rotated by the same angle
+     * @details Coördinates are passed as separate arrays of x and y (rather
+     * than as Points) so that the compiler can vectorise the loop, and the
+     * sine and cosine of theta are only worked out once.
+     * @param origin_x,origin_y Origin of each subtension
+     * @param v_x,v_y Vector from each origin marking the ray to rotate
+     * @param theta Amount to rotate every ray by (Radians)
+     * @param out_x,out_y Where to write each subtended Point
+     * @warning All spans must be the same size
+     */
+    void subtend_points_from_vectors(
+        std::span<const Unit> origin_x,
+        std::span<const Unit> origin_y,
+        std::span<const Unit> v_x,
+        std::span<const Unit> v_y,
+        Radians theta,
+        std::span<Unit> out_x,
+        std::span<Unit> out_y
+    );
+
     // Higher-level geometry helpers
 
     /**
@@ -67,6 +93,43 @@ namespace com::saxbophone::triangberg {
      */
     bool are_intersecting(Line a, Line b);
 
+    /**
+     * @returns true if the insides of triangles a and b overlap, including
+     * when one is wholly inside the other
+     * @details After checking their bounding boxes, tests whether any of
+     * the six edges has the whole of the other triangle on its outside,
+     * which is the case exactly when the triangles are apart. That's a few
+     * dozen multiplications, with no trigonometry.
+     * @note Triangles which only touch, at a corner or along an edge (or
+     * with a corner on the other's edge), don't intersect, with a millionth
+     * of a unit's allowance for rounding. This is the test a Drawing uses to
+     * keep its triangles apart.
+     */
+    bool are_intersecting(const TriangleShape& a, const TriangleShape& b);
+
+    /**
+     * @brief Indices of two triangles in the same list, the lower first
+     */
+    struct TrianglePair {
+        std::size_t first;
+        std::size_t second;
+
+        bool operator==(const TrianglePair& other) const = default;
+    };
+
+    /**
+     * @brief Finds every pair of intersecting triangles in a list, such as
+     * a stored drawing that should have none
+     * @details Sorts the triangles by the left of their bounding boxes and
+     * sweeps across them from left to right, only testing triangles whose
+     * bounding boxes overlap against each other, rather than every triangle
+     * against every other. This takes O(n log n) time plus the time to test
+     * the pairs whose bounding boxes overlap in x, which for a drawing of
+     * many small triangles isn't many more than n.
+     * @returns every pair for which are_intersecting() is true, sorted
+     */
+    std::vector<TrianglePair> find_intersecting_triangles(std::span<const TriangleShape> triangles);
+
     /**
      * @params points vector of Points defining a polygon to test
      * @warning points must define a polygon in a clockwise or anticlockwise
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Optional scoped trace zones, written out as a Chrome trace-event JSON file
+ * which can be opened in Perfetto (https://ui.perfetto.dev) or
+ * `chrome://tracing`.
+ *
+ * @details Tracing is only compiled in when the library is built with the
+ * CMake option `TRIANGBERG_ENABLE_TRACING=ON`. Otherwise, the
+ * TRIANGBERG_TRACE_ZONE() macro expands to nothing and costs nothing.
+ * @details Each thread records its zones into its own buffer without taking
+ * any locks. All buffers are written out when the program exits, to the file
+ * named by the `TRIANGBERG_TRACE_FILE` environment variable, or else to
+ * `triangberg-trace.json` in the working directory.
+ *
+ * @author Your Name <your.email.address@goes.here>
+ * @date Creation/Edit Date
+ *
+ * @copyright Copyright information goes here
+ *
+ * @copyright
+ * Copyright information can span multiple paragraphs if needed, such as if you
+ * use a well-known software license for which license header text (to be
+ * placed in locations like these) are provided by the license custodians.
+ *
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TRACE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TRACE_HPP
+
+#ifdef TRIANGBERG_TRACING
+
+#include <chrono>
+
+namespace com::saxbophone::triangberg::trace {
+    /**
+     * @brief Records the time between its construction and destruction as a
+     * trace zone on the current thread
+     * @warning name must be a string literal (or otherwise outlive the
+     * program), as only the pointer is kept.
+     */
+    class Zone {
+    public:
+        explicit Zone(const char* name);
+
+        Zone(const Zone&) = delete;
+
+        Zone& operator=(const Zone&) = delete;
+
+        ~Zone();
+
+    private:
+        const char* _name;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define TRIANGBERG_TRACE_CONCAT_IMPL(a, b) a##b
+#define TRIANGBERG_TRACE_CONCAT(a, b) TRIANGBERG_TRACE_CONCAT_IMPL(a, b)
+/**
+ * @brief Traces the rest of the enclosing scope as a zone called name
+ */
+#define TRIANGBERG_TRACE_ZONE(name) \
+    ::com::saxbophone::triangberg::trace::Zone TRIANGBERG_TRACE_CONCAT(triangberg_trace_zone_, __LINE__)(name)
+
+#else
+
+#define TRIANGBERG_TRACE_ZONE(name) do {} while (false)
+
+#endif
+
+#endif // include guard
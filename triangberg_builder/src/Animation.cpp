@@ -0,0 +1,267 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/trace.hpp>
+
+#include "parallel.hpp"
+#include "raster.hpp"
+
+namespace {
+    using namespace com::saxbophone::triangberg;
+
+    // the viewer's screen
+    const Unit SCREEN_WIDTH = 800;
+    const Unit SCREEN_HEIGHT = 600;
+
+    // how many frames each worker may get ahead of the one being written
+    const std::size_t FRAMES_AHEAD_PER_THREAD = 2;
+
+    std::uint8_t to_byte(Unit value) {
+        return (std::uint8_t)std::clamp(std::lround(value), 0l, 255l);
+    }
+}
+
+namespace com::saxbophone::triangberg {
+    Sweep::Sweep()
+      : _angle(0.1)
+      , _p(0.01)
+      , _base_angle(0)
+      , _angle_delta(0.1)
+      , _p_delta(0.01)
+      {}
+
+    AnimationFrame Sweep::next() {
+        AnimationFrame frame = {this->_angle, this->_p, this->_base_angle};
+        this->_angle += this->_angle_delta;
+        this->_base_angle -= (this->_angle_delta * 0.75);
+        if (0.1 >= this->_angle or this->_angle >= 119.9) {
+            this->_angle_delta *= -1;
+            this->_p += this->_p_delta;
+            if (0.01 >= this->_p or this->_p >= 0.99) {
+                this->_p_delta *= -1;
+            }
+        }
+        return frame;
+    }
+
+    Y4mSink::Y4mSink(std::ostream& stream, std::size_t fps)
+      : _stream(stream)
+      , _fps(fps)
+      , _started(false)
+      {}
+
+    void Y4mSink::write(const Image& frame) {
+        TRIANGBERG_TRACE_ZONE("Y4mSink::write");
+        if (not this->_started) {
+            this->_stream
+                << "YUV4MPEG2 W" << frame.width << " H" << frame.height << " F" << this->_fps
+                << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+            this->_started = true;
+        }
+        // colour planes are half the size each way, rounding up
+        std::size_t chroma_width = (frame.width + 1) / 2;
+        std::size_t chroma_height = (frame.height + 1) / 2;
+        std::size_t luma_size = frame.width * frame.height;
+        std::size_t chroma_size = chroma_width * chroma_height;
+        this->_planes.resize(luma_size + 2 * chroma_size);
+        std::uint8_t* y_plane = this->_planes.data();
+        std::uint8_t* cb_plane = y_plane + luma_size;
+        std::uint8_t* cr_plane = cb_plane + chroma_size;
+        auto pixel = [&](std::size_t x, std::size_t y) {
+            return &frame.pixels[(y * frame.width + x) * 3];
+        };
+        for (std::size_t y = 0; y < frame.height; y++) {
+            for (std::size_t x = 0; x < frame.width; x++) {
+                const std::uint8_t* rgb = pixel(x, y);
+                y_plane[y * frame.width + x] = to_byte(0.299 * rgb[0] + 0.587 * rgb[1] + 0.114 * rgb[2]);
+            }
+        }
+        for (std::size_t y = 0; y < chroma_height; y++) {
+            for (std::size_t x = 0; x < chroma_width; x++) {
+                // average the colour of the (up to) 2x2 pixels, which the conversion being linear allows
+                Unit r = 0, g = 0, b = 0;
+                for (std::size_t dy = 0; dy < 2; dy++) {
+                    for (std::size_t dx = 0; dx < 2; dx++) {
+                        const std::uint8_t* rgb = pixel(
+                            std::min(2 * x + dx, frame.width - 1), std::min(2 * y + dy, frame.height - 1)
+                        );
+                        r += rgb[0];
+                        g += rgb[1];
+                        b += rgb[2];
+                    }
+                }
+                r /= 4;
+                g /= 4;
+                b /= 4;
+                cb_plane[y * chroma_width + x] = to_byte(128 - 0.168736 * r - 0.331264 * g + 0.5 * b);
+                cr_plane[y * chroma_width + x] = to_byte(128 + 0.5 * r - 0.418688 * g - 0.081312 * b);
+            }
+        }
+        this->_stream << "FRAME\n";
+        this->_stream.write(reinterpret_cast<const char*>(this->_planes.data()), (std::streamsize)this->_planes.size());
+    }
+
+    void Y4mSink::finish() {
+        this->_stream.flush();
+    }
+
+    PpmSequenceSink::PpmSequenceSink(std::filesystem::path directory)
+      : _directory(std::move(directory))
+      , _next(0)
+      {}
+
+    void PpmSequenceSink::write(const Image& frame) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06zu.ppm", this->_next++);
+        std::ofstream file(this->_directory / name, std::ios::binary | std::ios::trunc);
+        file << "P6\n" << frame.width << ' ' << frame.height << "\n255\n";
+        file.write(reinterpret_cast<const char*>(frame.pixels.data()), (std::streamsize)frame.pixels.size());
+    }
+
+    Drawing build_frame(const AnimationFrame& frame, std::size_t max_triangles, std::pmr::memory_resource* resource) {
+        TRIANGBERG_TRACE_ZONE("build_frame");
+        // NOTE: the same as the viewer builds each frame with
+        Drawing drawing(
+            {SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2}, 20, frame.base_angle, 1, frame.p, frame.angle,
+            {SCREEN_WIDTH, SCREEN_HEIGHT}, resource
+        );
+        drawing.add_triangles(max_triangles);
+        return drawing;
+    }
+
+    std::vector<Drawing> build_many(
+        std::span<const AnimationFrame> frames,
+        std::size_t max_triangles,
+        std::size_t threads,
+        std::pmr::memory_resource* resource
+    ) {
+        TRIANGBERG_TRACE_ZONE("build_many");
+        std::vector<std::optional<Drawing>> built(frames.size());
+        PRIVATE::parallel_for(
+            frames.size(), threads,
+            [&](std::size_t f) { built[f].emplace(build_frame(frames[f], max_triangles, resource)); }
+        );
+        std::vector<Drawing> drawings;
+        drawings.reserve(frames.size());
+        for (std::optional<Drawing>& drawing : built) {
+            drawings.push_back(std::move(*drawing));
+        }
+        return drawings;
+    }
+
+    Image render_frame(const AnimationFrame& frame, Unit scale, std::size_t max_triangles) {
+        TRIANGBERG_TRACE_ZONE("render_frame");
+        std::pmr::monotonic_buffer_resource arena;
+        Drawing drawing = build_frame(frame, max_triangles, &arena);
+        Image image = {
+            (std::size_t)std::lround(SCREEN_WIDTH * scale), (std::size_t)std::lround(SCREEN_HEIGHT * scale), {},
+        };
+        image.pixels.resize(image.width * image.height * 3);
+        const std::array<PRIVATE::Rgb, 3> colours = {{{255, 0, 0}, {0, 255, 0}, {0, 0, 255}}};
+        for (const TriangleShape& triangle : drawing.snapshot()) {
+            PRIVATE::shade_triangle(image.pixels, image.width, image.height, triangle, colours, {0, 0}, scale);
+        }
+        return image;
+    }
+
+    void render_animation(const AnimationSettings& settings, FrameSink& sink) {
+        TRIANGBERG_TRACE_ZONE("render_animation");
+        // the schedule is cheap to work out, so is done up front for workers to pick from
+        Sweep sweep;
+        for (std::size_t f = 0; f < settings.first_frame; f++) {
+            sweep.next();
+        }
+        std::vector<AnimationFrame> schedule(settings.frames);
+        for (AnimationFrame& frame : schedule) {
+            frame = sweep.next();
+        }
+        std::size_t threads = PRIVATE::thread_count(settings.threads);
+        std::size_t window = threads * FRAMES_AHEAD_PER_THREAD;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::size_t next_to_render = 0;
+        std::size_t next_to_write = 0;
+        std::map<std::size_t, Image> finished; // reorder buffer, of frames not yet written
+        bool abandoned = false; // once anything has thrown, so that nobody waits for it forever
+        auto render = [&] {
+            std::unique_lock lock(mutex);
+            while (not abandoned and next_to_render < schedule.size()) {
+                // don't get too far ahead of the writer, so as not to fill memory with frames
+                if (next_to_render >= next_to_write + window) {
+                    changed.wait(lock);
+                    continue;
+                }
+                std::size_t f = next_to_render++;
+                lock.unlock();
+                Image image = render_frame(schedule[f], settings.scale, settings.max_triangles);
+                lock.lock();
+                finished.emplace(f, std::move(image));
+                changed.notify_all();
+            }
+        };
+        // write frames out as soon as they're ready, in order
+        auto write = [&] {
+            while (next_to_write < schedule.size()) {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] { return abandoned or finished.contains(next_to_write); });
+                if (abandoned) {
+                    return;
+                }
+                Image image = std::move(finished.extract(next_to_write).mapped());
+                lock.unlock();
+                sink.write(image);
+                lock.lock();
+                next_to_write++;
+                changed.notify_all();
+            }
+        };
+        // the calling thread is the writer, the rest render
+        PRIVATE::run_on_threads(
+            threads + 1,
+            [&](std::size_t worker) {
+                try {
+                    if (worker == 0) {
+                        write();
+                    } else {
+                        render();
+                    }
+                } catch (...) {
+                    {
+                        std::lock_guard lock(mutex);
+                        abandoned = true;
+                    }
+                    changed.notify_all();
+                    throw;
+                }
+            }
+        );
+        sink.finish();
+    }
+}
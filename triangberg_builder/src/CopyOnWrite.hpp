@@ -0,0 +1,166 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_COPY_ON_WRITE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_COPY_ON_WRITE_HPP
+
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    /*
+     * whether the given pointer is the only owner of what it points to, so that it can be changed
+     * in place without any other owner seeing
+     */
+    template <typename T>
+    bool owned_uniquely(const std::shared_ptr<T>& pointer) {
+        if (pointer.use_count() != 1) {
+            return false;
+        }
+        // the last other owner may have let go of it on another thread, whose reads of it must
+        // happen before any of our writes --this pairs with the release of its reference count
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+
+    /*
+     * A value which is shared between copies until one of them changes it, at which point that
+     * one gets a copy of its own to change
+     * NOTE: different copies can be used from different threads at once, but any one copy can
+     * only be used by one thread at a time
+     * NOTE: T is copied with uses-allocator construction, so any std::pmr containers in it (or T
+     * itself, if it has an allocator_type) keep using the same memory resource
+     */
+    template <typename T>
+    class CopyOnWrite {
+    public:
+        typedef std::pmr::polymorphic_allocator<> Allocator;
+
+        template <typename... Args>
+        explicit CopyOnWrite(Allocator allocator, Args&&... args)
+          : _allocator(allocator)
+          , _value(std::allocate_shared<T>(allocator, std::forward<Args>(args)...))
+          {}
+
+        const T& operator*() const {
+            return *this->_value;
+        }
+
+        const T* operator->() const {
+            return this->_value.get();
+        }
+
+        // returns the value, ready to be changed
+        T& edit() {
+            if (not owned_uniquely(this->_value)) {
+                this->_value = std::allocate_shared<T>(this->_allocator, *this->_value);
+            }
+            return *this->_value;
+        }
+
+    private:
+        Allocator _allocator;
+        std::shared_ptr<T> _value;
+    };
+
+    /*
+     * A vector which can be copied in O(1), sharing all its elements with the copy until either
+     * of them is changed
+     * Elements are kept in chunks of CHUNK_SIZE. Changing an element that's shared copies only
+     * the chunk it's in, along with the table of chunks the first time after copying.
+     * NOTE: T must be default-constructible and shouldn't allocate when copied
+     * NOTE: the same threading rules as for CopyOnWrite apply
+     */
+    template <typename T, std::size_t CHUNK_SIZE = 64>
+    class PersistentVector {
+    public:
+        typedef std::pmr::polymorphic_allocator<> Allocator;
+
+        explicit PersistentVector(Allocator allocator)
+          : _allocator(allocator)
+          , _table(allocator)
+          , _size(0)
+          {}
+
+        std::size_t size() const {
+            return this->_size;
+        }
+
+        bool empty() const {
+            return this->_size == 0;
+        }
+
+        // NOTE: references are only valid until this vector is next changed
+        const T& operator[](std::size_t index) const {
+            return this->_table->chunks[index / CHUNK_SIZE]->items[index % CHUNK_SIZE];
+        }
+
+        const T& back() const {
+            return (*this)[this->_size - 1];
+        }
+
+        // returns the element at index, ready to be changed
+        T& edit(std::size_t index) {
+            return this->own(this->_table.edit().chunks[index / CHUNK_SIZE]).items[index % CHUNK_SIZE];
+        }
+
+        void push_back(const T& value) {
+            auto& chunks = this->_table.edit().chunks;
+            if (this->_size % CHUNK_SIZE == 0) {
+                chunks.push_back(std::allocate_shared<Chunk>(this->_allocator));
+            }
+            this->own(chunks.back()).items[this->_size % CHUNK_SIZE] = value;
+            this->_size++;
+        }
+
+        std::size_t chunk_count() const {
+            return this->_table->chunks.size();
+        }
+
+        // the elements in the given chunk, for looping over them quickly
+        std::span<const T> chunk(std::size_t index) const {
+            std::size_t size = std::min(CHUNK_SIZE, this->_size - index * CHUNK_SIZE);
+            return {this->_table->chunks[index]->items.data(), size};
+        }
+
+    private:
+        struct Chunk {
+            std::array<T, CHUNK_SIZE> items;
+        };
+
+        struct Table {
+            typedef Allocator allocator_type;
+
+            explicit Table(const allocator_type& allocator) : chunks(allocator) {}
+
+            Table(const Table& other, const allocator_type& allocator) : chunks(other.chunks, allocator) {}
+
+            std::pmr::vector<std::shared_ptr<Chunk>> chunks;
+        };
+
+        // makes sure nothing else shares the given chunk, so it can be changed
+        Chunk& own(std::shared_ptr<Chunk>& chunk) {
+            if (not owned_uniquely(chunk)) {
+                chunk = std::allocate_shared<Chunk>(this->_allocator, *chunk);
+            }
+            return *chunk;
+        }
+
+        Allocator _allocator;
+        CopyOnWrite<Table> _table;
+        std::size_t _size;
+    };
+}
+
+#endif // include guard
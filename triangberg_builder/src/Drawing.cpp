@@ -4,12 +4,28 @@
  * <Copyright information goes here>
  */
 
+// get M_PI
+#define _USE_MATH_DEFINES
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <exception>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
-#include <set>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include <triangberg_builder/types.hpp>
@@ -17,7 +33,15 @@
 #include <triangberg_builder/Drawing.hpp>
 #include <triangberg_builder/Line.hpp>
 #include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
 #include <triangberg_builder/Vector.hpp>
+#include <triangberg_builder/trace.hpp>
+
+#include "CopyOnWrite.hpp"
+#include "coverage.hpp"
+#include "IndexedHeap.hpp"
+#include "parallel.hpp"
 
 namespace {
     using namespace com::saxbophone::triangberg;
@@ -34,16 +58,67 @@ namespace {
                 K = { 1, 11},
                 M = { 6, 20};
 
-    class Triangle; // forward-declaration
+    // all of the Builder's memory comes from the Drawing's memory resource
+    typedef std::pmr::polymorphic_allocator<> Allocator;
+
+    // every new triangle is equilateral, so needs this much free angle at each of its vertices
+    const Radians TRIANGLE_ANGLE = M_PI / 3;
+    // tolerance for a gap being just big enough to fit a triangle in, allowing for rounding error
+    const Radians ANGLE_TOLERANCE = 1e-6;
+    // how close two triangles' bounding boxes can get before their edges need testing against each other
+    const Unit BOUNDS_TOLERANCE = 1e-6;
+    // how many candidate triangles to build at once
+    const std::size_t CANDIDATE_BATCH_SIZE = 64;
+    // how many pairs of vertices to try between checks of the time (or for being stopped), when searching
+    // against the clock
+    const std::size_t PAIRS_PER_CLOCK_CHECK = 256;
+    // how many cells of the spatial index of ranked candidates there are across the screen, when there's no
+    // maximum edge length to size them by
+    const std::size_t RANKING_GRID_RESOLUTION = 32;
+    // ranked candidates spanning more cells than this aren't indexed by cell, but checked after every step
+    const std::size_t MAX_RANKING_CELLS = 16;
+
+    typedef std::chrono::steady_clock::time_point Deadline;
+    // for when there's all the time in the world
+    const Deadline NO_DEADLINE = Deadline::max();
+
+    // makes room for at least size elements, at least doubling the capacity if it has to grow at all
+    template <typename T>
+    void reserve_geometrically(std::pmr::vector<T>& vector, std::size_t size) {
+        if (vector.capacity() < size) {
+            vector.reserve(std::max(size, vector.capacity() * 2));
+        }
+    }
+
+    // an angular range around a vertex, going anticlockwise from start
+    struct Sector {
+        Radians start; // in range 0..2π
+        Radians span;
+    };
+
+    // vertices are identified by their index in the Builder's table of them
+    typedef std::size_t VertexID;
+
+    // with every triangle equilateral, no more than this many can ever meet at a vertex
+    const std::size_t MAX_VERTEX_TRIANGLES = 6;
+
     class Vertex {
     public:
-        Vertex(Point position) : Vertex(position, true) {}
+        Vertex() = default;
 
-        Vertex(Point position, bool eligible) : _position(position), _eligible(eligible) {}
+        explicit Vertex(Point position, bool eligible = true)
+          : _position(position)
+          , _eligible(eligible)
+          {}
 
-        ~Vertex();
-        // Vertex needs to know about every Triangle that uses it
-        void add_triangle(std::shared_ptr<Triangle> triangle);
+        // Vertex needs to know about every triangle that uses it
+        // NOTE: self is the ID of this Vertex, to find which of the triangle's corners it is
+        void add_triangle(
+            std::size_t triangle,
+            const TriangleShape& corners,
+            const std::array<VertexID, 3>& vertices,
+            VertexID self
+        );
 
         Point get_position() const {
             return this->_position;
@@ -54,161 +129,159 @@ namespace {
         }
 
         std::size_t connected_triangles_count() const {
-            std::size_t count = 0;
-            // every non-null triangle pointer counts
-            for (const auto& t : this->_triangles) {
-                if (!t.expired()) {
-                    count++;
-                }
-            }
-            return count;
+            return this->_triangle_count;
         }
 
         // returns true if these two vertices share any common triangles
         bool common_to(const Vertex& other) const {
-            for (const auto& t : this->_triangles) {
-                if (other._triangles.contains(t)) {
-                    return true;
+            for (std::size_t t = 0; t < this->_triangle_count; t++) {
+                for (std::size_t u = 0; u < other._triangle_count; u++) {
+                    if (this->_triangles[t] == other._triangles[u]) {
+                        return true;
+                    }
                 }
             }
             return false;
         }
 
-    private:
-        Point _position;
-        std::set<std::weak_ptr<Triangle>, std::owner_less<std::weak_ptr<Triangle>>> _triangles;
-        bool _eligible;
-    };
-
-    class Triangle : public std::enable_shared_from_this<Triangle> {
-    public:
-        // ctor for initial triangle
-        Triangle(std::size_t id, Point centre, Degrees orientation, Unit size) : _id(id) {
-            // subtend a vertical upwards-pointing line around centre point
-            std::shared_ptr<Vertex> first_vertex = std::make_shared<Vertex>(
-                subtend_point_from_vector(
-                    centre, {0, -size},
-                    degrees_to_radians(orientation)
-                )
-            );
-            this->_vertices.push_back(first_vertex);
-            // subtend another two lines at intervals of 120°
-            for (std::size_t i = 1; i < 3; i++) {
-                std::shared_ptr<Vertex> vertex = std::make_shared<Vertex>(
-                    subtend_point_from_vector(
-                        centre, {0, -size},
-                        degrees_to_radians(orientation + 120 * i)
-                    )
-                );
-                this->_vertices.push_back(vertex);
+        // the largest angle around this Vertex not covered by any of its triangles
+        Radians largest_free_angle() const {
+            if (this->_sector_count == 0) {
+                return 2 * M_PI;
             }
-        }
-        // ctor for first triangle added (with vertex bound to a point on edge of first triangle)
-        Triangle(std::size_t id, Point first_point, Vector first_edge) : _id(id) {
-            // first vertex is given for us
-            // NOTE: this Vertex is not eligible for starting any more new Triangles
-            std::shared_ptr<Vertex> first_vertex = std::make_shared<Vertex>(first_point, false);
-            this->_vertices.push_back(first_vertex);
-            // for the second vertex we just follow the vector of the first edge from the first vertex
-            Point second_point = first_point + first_edge;
-            std::shared_ptr<Vertex> second_vertex = std::make_shared<Vertex>(second_point);
-            this->_vertices.push_back(second_vertex);
-            // for the final vertex we need to subtend the first_edge by 60° around the first_point
-            std::shared_ptr<Vertex> third_vertex = std::make_shared<Vertex>(
-                subtend_point_from_vector(
-                    first_point, first_edge,
-                    degrees_to_radians(60)
-                )
-            );
-            this->_vertices.push_back(third_vertex);
-        }
-        // ctor used for all other triangles, whose vertices are shared with existing triangles
-        Triangle(std::size_t id, std::shared_ptr<Vertex> first, std::shared_ptr<Vertex> second) : _id(id) {
-            // add the first two vertices
-            this->_vertices.insert(this->_vertices.end(), {first, second});
-            // work out what the vector of the first edge is
-            Point first_point = first->get_position();
-            Point second_point = second->get_position();
-            Vector first_edge = second_point - first_point;
-            // subtend this vector about the first point to find the third point
-            std::shared_ptr<Vertex> third_vertex = std::make_shared<Vertex>(
-                subtend_point_from_vector(
-                    first_point, first_edge,
-                    degrees_to_radians(60)
-                )
-            );
-            this->_vertices.push_back(third_vertex);
-        }
-        // needed to update references to this Triangle from its Vertices (can't be done in ctor)
-        void update_references() {
-            for (auto& vertex : this->_vertices) {
-                vertex->add_triangle(shared_from_this());
+            // unwrap sectors crossing 0 into two pieces so they can be swept in a line
+            std::array<Sector, 2 * MAX_VERTEX_TRIANGLES> sectors;
+            std::size_t count = 0;
+            for (std::size_t s = 0; s < this->_sector_count; s++) {
+                const Sector& sector = this->_sectors[s];
+                if (sector.start + sector.span > 2 * M_PI) {
+                    sectors[count++] = {sector.start, 2 * M_PI - sector.start};
+                    sectors[count++] = {0, sector.start + sector.span - 2 * M_PI};
+                } else {
+                    sectors[count++] = sector;
+                }
             }
-        }
-        // returns the Shape of this Triangle
-        Drawing::Shape get_shape() const {
-            Drawing::Shape shape;
-            for (auto vertex : this->_vertices) {
-                shape.push_back(vertex->get_position());
+            std::sort(
+                sectors.begin(), sectors.begin() + (std::ptrdiff_t)count,
+                [](const Sector& a, const Sector& b) { return a.start < b.start; }
+            );
+            Radians largest = 0;
+            Radians covered_to = sectors.front().start + sectors.front().span;
+            for (std::size_t s = 0; s < count; s++) {
+                largest = std::max(largest, sectors[s].start - covered_to);
+                covered_to = std::max(covered_to, sectors[s].start + sectors[s].span);
             }
-            return shape;
+            // the gap from the last sector round past 0 to the first
+            return std::max(largest, 2 * M_PI - covered_to + sectors.front().start);
         }
-        std::shared_ptr<Vertex> get_vertex(std::size_t id) {
-            return this->_vertices[id];
+
+    private:
+        // NOTE: fixed-size, so that copying a Vertex never allocates
+        Point _position = {0, 0};
+        std::array<std::size_t, MAX_VERTEX_TRIANGLES> _triangles = {};
+        std::array<Sector, MAX_VERTEX_TRIANGLES> _sectors = {}; // the angle taken up by each of _triangles
+        std::uint8_t _triangle_count = 0;
+        std::uint8_t _sector_count = 0;
+        bool _eligible = false;
+    };
+
+    void Vertex::add_triangle(
+        std::size_t triangle,
+        const TriangleShape& corners,
+        const std::array<VertexID, 3>& vertices,
+        VertexID self
+    ) {
+        auto known = this->_triangles.begin() + this->_triangle_count;
+        if (std::find(this->_triangles.begin(), known, triangle) != known) {
+            return;
         }
-        Line get_edge(std::size_t id) {
-            return Line {
-                get_vertex(id)->get_position(),
-                get_vertex((id + 1) % this->_vertices.size())->get_position()
-            };
+        if (this->_triangle_count == MAX_VERTEX_TRIANGLES) {
+            // only possible with seed triangles that aren't equilateral, and there's no room left anyway
+            this->_eligible = false;
+            return;
         }
-        std::size_t get_id() const {
-            return this->_id;
-        }
-        // determines whether this Triangle intersects with any in the given vector
-        bool intersects_with(std::vector<std::shared_ptr<Triangle>> others) {
-            for (auto t : others) {
-                for (std::size_t i = 0; i < 3; i++) {
-                    for (std::size_t j = 0; j < 3; j++) {
-                        Line our_edge = this->get_edge(i);
-                        Line their_edge = t->get_edge(j);
-                        // XXX: the intersection code is a bit false-positivy
-                        // XXX: skip checking intersections when a vertice is shared
-                        if (
-                            our_edge.origin == their_edge.origin or
-                            our_edge.origin == their_edge.destination or
-                            our_edge.destination == their_edge.origin or
-                            our_edge.destination == their_edge.destination
-                        ) {
-                            continue;
-                        }
-                        if (are_intersecting(our_edge, their_edge)) {
-                            // std::cout << "INTERSECT " << t->get_id() << " : (" << our_edge.origin.x << ", "
-                            // << our_edge.origin.y << ")->(" << our_edge.destination.x << ", "
-                            // << our_edge.destination.y << ") with (" << their_edge.origin.x << ", "
-                            // << their_edge.origin.y << ")->(" << their_edge.destination.x << ", "
-                            // << their_edge.destination.y << ")" << std::endl;
-                            return true;
-                        }
-                    }
-                }
+        this->_triangles[this->_triangle_count++] = triangle;
+        // work out which of the triangle's corners we are, to find the angle it takes up here
+        for (std::size_t v = 0; v < 3; v++) {
+            if (vertices[v] != self or this->_sector_count == MAX_VERTEX_TRIANGLES) {
+                continue;
             }
-            return false;
+            Vector a = corners[(v + 1) % 3] - this->_position;
+            Vector b = corners[(v + 2) % 3] - this->_position;
+            Radians theta = angle_between(a, b);
+            // sector runs anticlockwise from whichever edge comes first going that way
+            Vector from = theta > 0 ? a : b;
+            Radians start = std::atan2(from.y, from.x);
+            this->_sectors[this->_sector_count++] = {start < 0 ? start + 2 * M_PI : start, std::abs(theta)};
+        }
+        // retire this Vertex if there's no longer room for a new triangle anywhere around it
+        if (this->largest_free_angle() < TRIANGLE_ANGLE - ANGLE_TOLERANCE) {
+            this->_eligible = false;
         }
+    }
 
-    private:
-        std::size_t _id; // tracking identity explicitly is better than pointers
-        std::vector<std::shared_ptr<Vertex>> _vertices;
+    // the edges of a triangle, going round its corners in order
+    Line edge_of(const TriangleShape& triangle, std::size_t id) {
+        return {triangle[id], triangle[(id + 1) % 3]};
+    }
+
+    // axis-aligned bounding box of a triangle
+    struct Bounds {
+        Unit min_x;
+        Unit min_y;
+        Unit max_x;
+        Unit max_y;
+
+        // NOTE: a little generous, so that rounding can't make this disagree with the edge tests
+        bool overlaps(const Bounds& other) const {
+            return
+                this->min_x <= other.max_x + BOUNDS_TOLERANCE and
+                other.min_x <= this->max_x + BOUNDS_TOLERANCE and
+                this->min_y <= other.max_y + BOUNDS_TOLERANCE and
+                other.min_y <= this->max_y + BOUNDS_TOLERANCE;
+        }
     };
 
-    Vertex::~Vertex() = default;
+    Bounds bounds_of(const TriangleShape& triangle) {
+        return {
+            std::min({triangle[0].x, triangle[1].x, triangle[2].x}),
+            std::min({triangle[0].y, triangle[1].y, triangle[2].y}),
+            std::max({triangle[0].x, triangle[1].x, triangle[2].x}),
+            std::max({triangle[0].y, triangle[1].y, triangle[2].y}),
+        };
+    }
 
-    // implemented out-of-class to avoid error due to incomplete type Triangle
-    void Vertex::add_triangle(std::shared_ptr<Triangle> triangle) {
-        if (triangle) {
-            this->_triangles.insert(triangle);
+    // corners of the initial triangle
+    TriangleShape initial_triangle(Point centre, Degrees orientation, Unit size) {
+        TriangleShape corners;
+        // subtend a vertical upwards-pointing line around centre point, then another two lines at intervals of 120°
+        for (std::size_t i = 0; i < 3; i++) {
+            corners[i] = subtend_point_from_vector(
+                centre, {0, -size},
+                degrees_to_radians(orientation + 120 * (Degrees)i)
+            );
         }
+        return corners;
+    }
+
+    // corners of the first triangle added (with its first vertex bound to a point on an edge of the initial one)
+    TriangleShape branched_triangle(Point first_point, Vector first_edge) {
+        return {
+            // first vertex is given for us
+            first_point,
+            // for the second vertex we just follow the vector of the first edge from the first vertex
+            first_point + first_edge,
+            // for the final vertex we need to subtend the first_edge by 60° around the first_point
+            subtend_point_from_vector(first_point, first_edge, degrees_to_radians(60)),
+        };
     }
+
+    // a triangle which could be added next, made from two existing vertices and a new third one
+    struct Candidate {
+        VertexID first;
+        VertexID second;
+        TriangleShape corners;
+    };
 }
 
 namespace com::saxbophone::triangberg {
@@ -221,19 +294,96 @@ namespace com::saxbophone::triangberg {
             EdgeID branch_edge,
             Percentage branch_point,
             Degrees branch_angle,
-            Vector screen_size
+            Vector screen_size,
+            std::pmr::memory_resource* resource
         )
-          : _triangles{std::make_shared<Triangle>(0, origin, rotation, size)}
-          , _branch_edge(branch_edge)
-          , _branch_point(branch_point)
-          , _branch_angle(branch_angle)
-          , _screen_size(screen_size)
+          : Builder(screen_size, resource)
+          {
+            this->_branch_edge = branch_edge;
+            this->_branch_point = branch_point;
+            this->_branch_angle = branch_angle;
+            TriangleShape corners = initial_triangle(origin, rotation, size);
+            this->accept(
+                {this->add_vertex(corners[0]), this->add_vertex(corners[1]), this->add_vertex(corners[2])},
+                corners
+            );
+        }
+
+        Builder(
+            std::span<const TriangleShape> seeds,
+            Vector screen_size,
+            std::pmr::memory_resource* resource
+        )
+          : Builder(screen_size, resource)
           {
-            this->_triangles.back()->update_references();
+            // seed triangles which share a corner must share the same Vertex
+            std::pmr::map<std::pair<Unit, Unit>, VertexID> vertices(this->_allocator);
+            for (const TriangleShape& seed : seeds) {
+                std::array<VertexID, 3> corners;
+                for (std::size_t c = 0; c < 3; c++) {
+                    auto [vertex, added] = vertices.try_emplace({seed[c].x, seed[c].y}, this->_vertices.size());
+                    if (added) {
+                        this->add_vertex(seed[c]);
+                    }
+                    corners[c] = vertex->second;
+                }
+                this->accept(corners, seed);
+            }
+        }
+
+        // shares everything except scratch space with other, for forking
+        // NOTE: all of the shared state is copied on write, so other can carry on being used as before
+        Builder(const Builder& other)
+          : _allocator(other._allocator)
+          , _vertices(other._vertices)
+          , _placed(other._placed)
+          , _coverage(other._coverage)
+          , _live_vertices(other._live_vertices)
+          , _candidates(_allocator)
+          , _batch(_allocator)
+          , _vertex_groups(_allocator)
+          , _vertex_group_ids(_allocator)
+          , _cells(_allocator)
+          , _close_pairs(_allocator)
+          , _ranked_nearby(_allocator)
+          , _scorer(other._scorer)
+          , _ranking(other._ranking)
+          , _store(other._store, _allocator.resource())
+          , _branch_edge(other._branch_edge)
+          , _branch_point(other._branch_point)
+          , _branch_angle(other._branch_angle)
+          , _screen_origin(other._screen_origin)
+          , _screen_size(other._screen_size)
+          , _min_edge_length(other._min_edge_length)
+          , _max_edge_length(other._max_edge_length)
+          , _stats(other._stats)
+          {}
+
+        void set_bounds(Point top_left, Vector size) {
+            this->_search.paused = false;
+            // candidates ranked so far were only checked against the old bounds
+            this->forget_ranking();
+            this->_screen_origin = top_left;
+            this->_screen_size = size;
+            // the coverage grid only covers the screen, so has to start again from scratch
+            PRIVATE::CoverageGrid& coverage = this->_coverage.edit();
+            coverage.reset(top_left, size);
+            for (std::size_t c = 0; c < this->_placed.chunk_count(); c++) {
+                for (const PlacedTriangle& placed : this->_placed.chunk(c)) {
+                    coverage.add(placed.corners);
+                }
+            }
+        }
+
+        void set_edge_length_bounds(Unit min, Unit max) {
+            this->_search.paused = false;
+            this->forget_ranking();
+            this->_min_edge_length = min;
+            this->_max_edge_length = max;
         }
 
         void add_second_triangle(Unit size) {
-            Line branch_line = this->_triangles[0]->get_edge(this->_branch_edge);
+            Line branch_line = edge_of(this->_placed[0].corners, this->_branch_edge);
             // get the vector of the line
             Vector line_vector = branch_line;
             // create a scaled version of that vector
@@ -258,116 +408,930 @@ namespace com::saxbophone::triangberg {
             );
             // only then can we make the second triangle by passing it the branch point
             // the vector that describes the first edge
-            this->_triangles.push_back(
-                std::make_shared<Triangle>(1, first_point, branching_edge - first_point)
+            TriangleShape corners = branched_triangle(first_point, branching_edge - first_point);
+            // NOTE: the first Vertex is not eligible for starting any more new triangles
+            this->accept(
+                {
+                    this->add_vertex(corners[0], false),
+                    this->add_vertex(corners[1]),
+                    this->add_vertex(corners[2]),
+                },
+                corners
             );
-            this->_triangles.back()->update_references();
         }
 
-        bool add_next_triangle() {
-            auto next_triangles = this->get_possible_next_triangles();
+        // switches between picking the first candidate found and the lowest-scored one
+        void set_scorer(Scorer scorer) {
+            this->_search.paused = false;
+            this->_scorer = std::move(scorer);
+            if (not this->_scorer) {
+                // back to first-found mode, ranked candidates no longer needed
+                this->forget_ranking();
+                return;
+            }
+            // re-score whatever we've already found with the new scorer
+            Ranking& ranking = this->_ranking.edit();
+            for (Handle h = 0; h < ranking.heap.capacity(); h++) {
+                if (ranking.heap.contains(h)) {
+                    Rank rank = ranking.heap.key(h);
+                    rank.score = this->_scorer(ranking.candidates[h].corners);
+                    ranking.heap.update(h, rank);
+                }
+            }
+        }
+
+        // the outcome of trying to add a triangle
+        enum class Step {
+            ADDED,
+            FINISHED, // there was nowhere left to add one
+            OUT_OF_TIME, // the search for one will carry on where it stopped next time
+        };
+
+        Step add_next_triangle(Deadline deadline = NO_DEADLINE, const std::stop_token& stop = {}) {
+            if (this->_scorer) {
+                return this->add_best_triangle(deadline, stop);
+            }
+            // only the first candidate found is ever used, so stop searching there
+            const auto& next_triangles = this->get_possible_next_triangles(1, deadline, stop);
+            if (this->is_search_paused()) {
+                return Step::OUT_OF_TIME;
+            }
             if (next_triangles.size() > 0) {
-                this->_triangles.push_back(next_triangles.front());
-                this->_triangles.back()->update_references();
+                this->accept(next_triangles.front());
+                return Step::ADDED;
+            }
+            return Step::FINISHED;
+        }
+
+        // adds a candidate found by this Builder, or by one it was forked from since it was found
+        void add_candidate(const Candidate& candidate) {
+            auto vertices = this->accept(candidate);
+            if (this->_ranking->seeded) {
+                this->update_ranked(vertices, candidate.corners);
+            }
+        }
+
+        // the candidate that add_next_triangle() would add, if any, without adding it
+        // NOTE: only for when no scorer is set
+        std::optional<Candidate> find_next_triangle() {
+            const auto& next_triangles = this->get_possible_next_triangles(1);
+            if (next_triangles.empty()) {
+                return std::nullopt;
+            }
+            return next_triangles.front();
+        }
+
+        // whether a candidate that was found before any obstacles were added since is still valid
+        bool is_still_valid(const Candidate& candidate) const {
+            return not this->is_covered(candidate.corners) and not this->intersects_any(candidate.corners, bounds_of(candidate.corners));
+        }
+
+        // adds a triangle that new triangles mustn't overlap, but which isn't part of this drawing
+        // NOTE: only for when no scorer is set, as ranked candidates aren't checked against it
+        void add_obstacle(const TriangleShape& corners) {
+            this->_search.paused = false;
+            this->_placed.push_back({corners, bounds_of(corners)});
+            this->_coverage.edit().add(corners);
+        }
+
+        // NOTE: safe to call from any thread, even while triangles are being added
+        TriangleStore::Snapshot snapshot() const {
+            return this->_store.snapshot();
+        }
+
+        Drawing::Stats get_stats() const {
+            return this->_stats;
+        }
+
+        double get_coverage() const {
+            return this->_coverage->coverage();
+        }
+
+        // returns a vector of possible new triangles we could place, up to limit of them
+        // if the deadline passes (or a stop is requested) first, the search is paused, to carry on where it
+        // stopped next time this is called --unless the Drawing is changed in the meantime
+        // NOTE: the returned buffer is reused, so is only valid until the next call
+        const std::pmr::vector<Candidate>& get_possible_next_triangles(
+            std::size_t limit = SIZE_MAX,
+            Deadline deadline = NO_DEADLINE,
+            const std::stop_token& stop = {}
+        ) {
+            TRIANGBERG_TRACE_ZONE("get_possible_next_triangles");
+            auto& candidates = this->_candidates;
+            SearchCursor& search = this->_search;
+            if (search.paused) {
+                search.paused = false;
+                if (candidates.size() >= limit) {
+                    return candidates; // found enough before it was paused
+                }
+            } else {
+                this->start_search();
+            }
+            const auto& vertices = *this->_live_vertices;
+            bool interruptible = deadline != NO_DEADLINE or stop.stop_possible();
+            std::size_t since_clock_check = 0;
+            while (search.remaining) {
+                auto [iv, jv] = this->current_pair();
+                search.remaining = this->advance_search();
+                // pairs are only validated a batch at a time, so this returns true once enough are found
+                if (this->queue_pair(vertices[iv].vertex, vertices[jv].vertex, limit)) {
+                    return candidates;
+                }
+                if (interruptible and ++since_clock_check == PAIRS_PER_CLOCK_CHECK) {
+                    since_clock_check = 0;
+                    if (stop.stop_requested() or std::chrono::steady_clock::now() >= deadline) {
+                        // what's queued is validated now, so that only the pairs left need remembering
+                        if (this->flush_batch(limit) or not search.remaining) {
+                            return candidates;
+                        }
+                        search.paused = true;
+                        return candidates;
+                    }
+                }
+            }
+            this->flush_batch(limit);
+            return candidates;
+        }
+
+        // whether the last search for candidates ran out of time before it finished
+        bool is_search_paused() const {
+            return this->_search.paused;
+        }
+
+        // sets up to search every pair of live vertices, or only the nearby ones if there's a maximum edge length
+        void start_search() {
+            this->_candidates.clear();
+            // NOTE: trying every pair of eligible vertices in this order finds candidates in the same
+            // order as trying every pair of triangles and then every pair of their vertices would,
+            // but without visiting shared or used-up vertices over and over again
+            const auto& vertices = *this->_live_vertices;
+            auto& groups = this->_vertex_groups;
+            groups.clear();
+            for (std::size_t v = 0; v < vertices.size(); v++) {
+                if (v == 0 or vertices[v].first_triangle != vertices[v - 1].first_triangle) {
+                    groups.push_back(v);
+                }
+            }
+            groups.push_back(vertices.size());
+            SearchCursor& search = this->_search;
+            search.close_pairs_only = not std::isinf(this->_max_edge_length);
+            if (search.close_pairs_only) {
+                // with a maximum edge length, only nearby pairs need trying, in the same order as above
+                search.pair = 0;
+                search.remaining = not this->find_close_pairs().empty();
+            } else {
+                search.i = 0;
+                search.j = 0;
+                search.iv = groups[0];
+                search.jv = groups[0];
+                search.remaining = not vertices.empty();
+            }
+        }
+
+        // the pair of live vertices the search is on
+        std::pair<std::size_t, std::size_t> current_pair() const {
+            const SearchCursor& search = this->_search;
+            if (search.close_pairs_only) {
+                return this->_close_pairs[search.pair];
+            }
+            return {search.iv, search.jv};
+        }
+
+        // moves the search on to the next pair, returning false if there are none left
+        bool advance_search() {
+            SearchCursor& search = this->_search;
+            if (search.close_pairs_only) {
+                return ++search.pair < this->_close_pairs.size();
+            }
+            // every vertex of group i against every one of group j, for every pair of groups in turn
+            const auto& groups = this->_vertex_groups;
+            if (++search.jv < groups[search.j + 1]) {
+                return true;
+            }
+            if (++search.iv < groups[search.i + 1]) {
+                search.jv = groups[search.j];
+                return true;
+            }
+            if (++search.j + 1 < groups.size()) {
+                search.iv = groups[search.i];
+                search.jv = groups[search.j];
+                return true;
+            }
+            if (++search.i + 1 < groups.size()) {
+                search.j = 0;
+                search.iv = groups[search.i];
+                search.jv = groups[0];
                 return true;
             }
             return false;
         }
 
-        std::vector<Shape> get_shapes() const {
-            std::vector<Shape> shapes;
-            for (const auto& t : this->_triangles) {
-                shapes.push_back(t->get_shape());
+        // finds every pair of live vertices close enough to make a triangle, in search order
+        // NOTE: the returned buffer is reused, so is only valid until the next call
+        const std::pmr::vector<std::pair<std::size_t, std::size_t>>& find_close_pairs() {
+            const auto& vertices = *this->_live_vertices;
+            const auto& groups = this->_vertex_groups;
+            auto& pairs = this->_close_pairs;
+            pairs.clear();
+            if (not (this->_max_edge_length > 0)) {
+                return pairs; // no triangle can be small enough
+            }
+            // bucket vertices into a grid of cells as big as the longest edge, so every vertex
+            // within range of another is either in the same cell or one of its neighbours
+            auto cell_of = [&](Point p) {
+                return Cell{
+                    (std::int64_t)std::floor(p.x / this->_max_edge_length),
+                    (std::int64_t)std::floor(p.y / this->_max_edge_length),
+                };
+            };
+            auto& cells = this->_cells;
+            cells.clear();
+            for (std::size_t v = 0; v < vertices.size(); v++) {
+                cells.push_back({cell_of(vertices[v].position), v});
+            }
+            std::sort(cells.begin(), cells.end());
+            for (std::size_t iv = 0; iv < vertices.size(); iv++) {
+                Point position = vertices[iv].position;
+                Cell cell = cell_of(position);
+                for (std::int64_t dy = -1; dy <= 1; dy++) {
+                    for (std::int64_t dx = -1; dx <= 1; dx++) {
+                        Cell neighbour = {cell.first + dx, cell.second + dy};
+                        auto begin = std::lower_bound(cells.begin(), cells.end(), std::make_pair(neighbour, (std::size_t)0));
+                        for (auto it = begin; it != cells.end() and it->first == neighbour; it++) {
+                            std::size_t jv = it->second;
+                            if ((vertices[jv].position - position).length() <= this->_max_edge_length) {
+                                pairs.push_back({iv, jv});
+                            }
+                        }
+                    }
+                }
+            }
+            // vertex iv is in group k when groups[k] <= iv < groups[k + 1]
+            auto& group_of = this->_vertex_group_ids;
+            group_of.resize(vertices.size());
+            for (std::size_t k = 0; k + 1 < groups.size(); k++) {
+                std::fill(group_of.begin() + (std::ptrdiff_t)groups[k], group_of.begin() + (std::ptrdiff_t)groups[k + 1], k);
             }
-            return shapes;
+            std::sort(
+                pairs.begin(), pairs.end(),
+                [&](const auto& a, const auto& b) {
+                    return std::tie(group_of[a.first], group_of[a.second], a.first, a.second)
+                         < std::tie(group_of[b.first], group_of[b.second], b.first, b.second);
+                }
+            );
+            return pairs;
         }
 
-        // returns a vector of all possible new Triangles we could place
-        std::vector<std::shared_ptr<Triangle>> get_possible_next_triangles() {
-            std::vector<std::shared_ptr<Triangle>> candidates;
+        // candidate search runs in three stages: pairs of vertices which the rules allow are queued
+        // up here, then a whole batch has its third vertices and bounding boxes built at once, then
+        // each of those is validated in the order queued, and only the valid ones are kept
+        // returns true once limit candidates have been found
+        bool queue_pair(VertexID i, VertexID j, std::size_t limit) {
+            const Vertex& i_vertex = this->_vertices[i];
+            const Vertex& j_vertex = this->_vertices[j];
             // rules:
             // - vertices must be from different triangles
             // - ignore ineligible vertices
-            // - resulting triangle must not intersect any other (not yet implemented)
-            for (std::size_t i = 0; i < this->_triangles.size(); i++) {
-                for (std::size_t j = 0; j < this->_triangles.size(); j++) {
-                    // if (i == j) {
-                    //     continue;
-                    // }
-                    for (std::size_t iv = 0; iv < 3; iv++) {
-                        std::shared_ptr<Vertex> i_vertex = this->_triangles[i]->get_vertex(iv);
-                        // skip early if vertex ineligible
-                        if (not i_vertex->is_eligible()) {
-                            continue;
-                        }
-                        for (std::size_t jv = 0; jv < 3; jv++) {
-                            std::shared_ptr<Vertex> j_vertex = this->_triangles[j]->get_vertex(jv);
-                            // skip early if vertex ineligible
-                            if (not j_vertex->is_eligible()) {
-                                continue;
-                            }
-                            // skip when it's the same triangle
-                            if (i_vertex->common_to(*j_vertex)) {
-                                continue;
-                            }
-                            // skip vertex-pairs where neither have only one triangle
-                            // if (i_vertex->connected_triangles_count() == 1 or j_vertex->connected_triangles_count() == 1) {
-                                // make the candidate Triangle
-                                std::shared_ptr<Triangle> candidate = std::make_shared<Triangle>(
-                                    this->_triangles.size(), i_vertex, j_vertex
-                                );
-                                // check that at least one of the candidate's vertices is on-screen
-                                std::size_t off_screen = 0;
-                                for (const auto& vertex : candidate->get_shape()) {
-                                    if (
-                                        vertex.x < 0 or
-                                        vertex.x > this->_screen_size.x or
-                                        vertex.y < 0 or
-                                        vertex.y > this->_screen_size.y
-                                    ) {
-                                        off_screen++;
-                                    }
-                                }
-                                bool plot = off_screen < 3;
-                                // or that at least one of its edges intersects the screen bounds
-                                if (not plot) {
-                                    Line screen_edges[] = {
-                                        {{0, 0}, {this->_screen_size.x, 0}},
-                                        {{0, 0}, {0, this->_screen_size.y}},
-                                        {{0, this->_screen_size.y}, {this->_screen_size.x, this->_screen_size.y}},
-                                        {{this->_screen_size.x, 0}, {this->_screen_size.x, this->_screen_size.y}},
-                                    };
-                                    for (std::size_t e = 0; e < 3; e++) {
-                                        for (auto edge : screen_edges) {
-                                            if (are_intersecting(candidate->get_edge(e), edge)) {
-                                                plot = true;
-                                                break;
-                                            }
-                                        }
-                                    }
-                                }
-                                if (plot) {
-                                    // add it if it doesn't intersect any of the others
-                                    if (not candidate->intersects_with(this->_triangles)) {
-                                        // XXX: here, we *would* check if the resultant triangle would overlap
-                                        // instead, we'll just assume that it doesn't for now...
-                                        candidates.push_back(candidate);
-                                    }
-                                }
-                            // }
+            // - resulting triangle must not intersect any other
+            if (not i_vertex.is_eligible() or not j_vertex.is_eligible()) {
+                this->reject(this->_stats.rejected_ineligible);
+                return false;
+            }
+            // skip when it's the same triangle
+            if (i_vertex.common_to(j_vertex)) {
+                this->reject(this->_stats.rejected_shared);
+                return false;
+            }
+            // skip when the triangle would be too big or too small
+            Unit edge_length = (j_vertex.get_position() - i_vertex.get_position()).length();
+            if (edge_length < this->_min_edge_length or edge_length > this->_max_edge_length) {
+                this->reject(this->_stats.rejected_size);
+                return false;
+            }
+            // skip vertex-pairs where neither have only one triangle
+            // if (i_vertex.connected_triangles_count() == 1 or j_vertex.connected_triangles_count() == 1) {
+            this->_batch.pairs.push_back({i, j});
+            if (this->_batch.pairs.size() == CANDIDATE_BATCH_SIZE) {
+                return this->flush_batch(limit);
+            }
+            return false;
+        }
+
+        // builds and validates everything queued, adding the valid ones to _candidates
+        // returns true once limit candidates have been found
+        bool flush_batch(std::size_t limit) {
+            this->build_batch();
+            bool done = this->validate_batch(limit);
+            this->_batch.pairs.clear();
+            return done;
+        }
+
+        // works out the corners and bounding box of every queued candidate
+        void build_batch() {
+            TRIANGBERG_TRACE_ZONE("build candidates");
+            CandidateBatch& batch = this->_batch;
+            std::size_t size = batch.pairs.size();
+            for (auto* column : {
+                &batch.first_x, &batch.first_y, &batch.edge_x, &batch.edge_y,
+                &batch.third_x, &batch.third_y,
+            }) {
+                column->resize(size);
+            }
+            for (std::size_t c = 0; c < size; c++) {
+                Point first = this->_vertices[batch.pairs[c].first].get_position();
+                Point second = this->_vertices[batch.pairs[c].second].get_position();
+                batch.first_x[c] = first.x;
+                batch.first_y[c] = first.y;
+                batch.edge_x[c] = second.x - first.x;
+                batch.edge_y[c] = second.y - first.y;
+            }
+            // the third vertex is found by subtending the first edge by 60° around the first vertex
+            subtend_points_from_vectors(
+                batch.first_x, batch.first_y, batch.edge_x, batch.edge_y,
+                degrees_to_radians(60),
+                batch.third_x, batch.third_y
+            );
+            batch.bounds.resize(size);
+            for (std::size_t c = 0; c < size; c++) {
+                batch.bounds[c] = {
+                    std::min({batch.first_x[c], batch.first_x[c] + batch.edge_x[c], batch.third_x[c]}),
+                    std::min({batch.first_y[c], batch.first_y[c] + batch.edge_y[c], batch.third_y[c]}),
+                    std::max({batch.first_x[c], batch.first_x[c] + batch.edge_x[c], batch.third_x[c]}),
+                    std::max({batch.first_y[c], batch.first_y[c] + batch.edge_y[c], batch.third_y[c]}),
+                };
+            }
+        }
+
+        // adds the built candidates which are on screen and don't intersect any triangle to _candidates
+        // returns true once limit candidates have been found
+        bool validate_batch(std::size_t limit) {
+            const CandidateBatch& batch = this->_batch;
+            for (std::size_t c = 0; c < batch.pairs.size(); c++) {
+                CandidatePair pair = batch.pairs[c];
+                TriangleShape corners = {
+                    this->_vertices[pair.first].get_position(),
+                    this->_vertices[pair.second].get_position(),
+                    Point{batch.third_x[c], batch.third_y[c]},
+                };
+                if (not this->is_on_screen(corners)) {
+                    this->reject(this->_stats.rejected_off_screen);
+                    continue;
+                }
+                if (this->is_covered(corners)) {
+                    this->reject(this->_stats.rejected_covered);
+                    continue;
+                }
+                if (this->intersects_any(corners, batch.bounds[c])) {
+                    this->reject(this->_stats.rejected_intersecting);
+                    continue;
+                }
+                this->_stats.pairs_tried++;
+                this->_stats.candidates++;
+                this->_candidates.push_back({pair.first, pair.second, corners});
+                if (this->_candidates.size() == limit) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void reject(std::size_t& reason) {
+            this->_stats.pairs_tried++;
+            reason++;
+        }
+
+        // whether the coverage grid shows the inside of the given candidate to be already filled
+        // NOTE: quicker than intersects_any(), but misses most overlaps that it finds
+        bool is_covered(const TriangleShape& candidate) const {
+            const PRIVATE::CoverageGrid& coverage = *this->_coverage;
+            Point centre = {
+                (candidate[0].x + candidate[1].x + candidate[2].x) / 3,
+                (candidate[0].y + candidate[1].y + candidate[2].y) / 3,
+            };
+            if (coverage.is_filled(centre)) {
+                return true;
+            }
+            // and halfway from there to each corner
+            for (Point corner : candidate) {
+                if (coverage.is_filled({(centre.x + corner.x) / 2, (centre.y + corner.y) / 2})) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // determines whether the given candidate intersects any accepted triangle
+        bool intersects_any(const TriangleShape& corners, const Bounds& bounds) const {
+            TRIANGBERG_TRACE_ZONE("intersects_with");
+            for (std::size_t c = 0; c < this->_placed.chunk_count(); c++) {
+                for (const PlacedTriangle& placed : this->_placed.chunk(c)) {
+                    // only triangles whose bounding boxes overlap can possibly intersect
+                    if (bounds.overlaps(placed.bounds) and are_intersecting(corners, placed.corners)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // whether any part of the given triangle is within the screen bounds
+        bool is_on_screen(const TriangleShape& candidate) const {
+            TRIANGBERG_TRACE_ZONE("screen culling");
+            // check that at least one of the candidate's vertices is on-screen
+            Point top_left = this->_screen_origin;
+            Point bottom_right = this->_screen_origin + this->_screen_size;
+            std::size_t off_screen = 0;
+            for (const auto& vertex : candidate) {
+                if (
+                    vertex.x < top_left.x or
+                    vertex.x > bottom_right.x or
+                    vertex.y < top_left.y or
+                    vertex.y > bottom_right.y
+                ) {
+                    off_screen++;
+                }
+            }
+            bool plot = off_screen < 3;
+            // or that at least one of its edges intersects the screen bounds
+            if (not plot) {
+                Line screen_edges[] = {
+                    {top_left, {bottom_right.x, top_left.y}},
+                    {top_left, {top_left.x, bottom_right.y}},
+                    {{top_left.x, bottom_right.y}, bottom_right},
+                    {{bottom_right.x, top_left.y}, bottom_right},
+                };
+                for (std::size_t e = 0; e < 3; e++) {
+                    for (auto edge : screen_edges) {
+                        if (are_intersecting(edge_of(candidate, e), edge)) {
+                            plot = true;
+                            break;
                         }
                     }
                 }
             }
-            return candidates;
+            return plot;
         }
 
     private:
-        std::vector<std::shared_ptr<Triangle>> _triangles;
+        // sets up an empty Builder, common to both public ctors
+        Builder(Vector screen_size, std::pmr::memory_resource* resource)
+          : _allocator(resource)
+          , _vertices(_allocator)
+          , _placed(_allocator)
+          , _coverage(_allocator)
+          , _live_vertices(_allocator)
+          , _candidates(_allocator)
+          , _batch(_allocator)
+          , _vertex_groups(_allocator)
+          , _vertex_group_ids(_allocator)
+          , _cells(_allocator)
+          , _close_pairs(_allocator)
+          , _ranked_nearby(_allocator)
+          , _ranking(_allocator)
+          , _store(resource)
+          , _branch_edge(0)
+          , _branch_point(0)
+          , _branch_angle(0)
+          , _screen_origin{0, 0}
+          , _screen_size(screen_size)
+          , _min_edge_length(0)
+          , _max_edge_length(INFINITY)
+          , _stats{}
+          {
+            this->_coverage.edit().reset(this->_screen_origin, this->_screen_size);
+        }
+
+        // ordering of ranked candidates: lowest score first, then first-found
+        struct Rank {
+            Unit score;
+            std::size_t discovered;
+
+            auto operator<=>(const Rank&) const = default;
+        };
+
+        typedef PRIVATE::IndexedHeap<Rank>::Handle Handle;
+
+        typedef std::pair<std::int64_t, std::int64_t> Cell;
+
+        // one entry of one of the lists ranked candidates are indexed by
+        struct RankingLink {
+            Handle candidate;
+            std::size_t next; // the next entry in the same list, or NO_LINK at the end
+        };
+
+        static constexpr std::size_t NO_LINK = SIZE_MAX;
+
+        // when a scorer is set, all valid candidates are kept ranked between steps
+        // they're indexed by vertex and by area, so each new triangle only has to recheck those it could affect
+        // NOTE: the indices are lists threaded through one shared pool of links, so that a candidate for a
+        // vertex or area not seen before doesn't need a container of its own allocating
+        struct Ranking {
+            typedef Allocator allocator_type;
+
+            explicit Ranking(const allocator_type& allocator)
+              : heap(allocator)
+              , candidates(allocator)
+              , seeded(false)
+              , discovered(0)
+              , cell_size(1)
+              , links(allocator)
+              , free_links(NO_LINK)
+              , by_vertex(allocator)
+              , by_cell(allocator)
+              , oversized(NO_LINK)
+              {}
+
+            Ranking(const Ranking& other, const allocator_type& allocator)
+              : heap(other.heap, allocator)
+              , candidates(other.candidates, allocator)
+              , seeded(other.seeded)
+              , discovered(other.discovered)
+              , cell_size(other.cell_size)
+              , links(other.links, allocator)
+              , free_links(other.free_links)
+              , by_vertex(other.by_vertex, allocator)
+              , by_cell(other.by_cell, allocator)
+              , oversized(other.oversized)
+              {}
+
+            PRIVATE::IndexedHeap<Rank> heap;
+            std::pmr::vector<Candidate> candidates; // indexed by heap handle
+            bool seeded;
+            std::size_t discovered; // tie-breaker, so equal scores are picked in the order found
+            Unit cell_size; // of by_cell, fixed from when the ranking was seeded
+            std::pmr::vector<RankingLink> links; // every list's entries, and the unused ones
+            std::size_t free_links; // first of the unused links
+            std::pmr::vector<std::size_t> by_vertex; // first link of the candidates using each vertex, by VertexID
+            // first link of the candidates whose bounds reach each cell, sorted by cell
+            std::pmr::vector<std::pair<Cell, std::size_t>> by_cell;
+            std::size_t oversized; // first link of the candidates whose bounds reach too many cells to index
+
+            // adds the given candidate to the front of the list starting at the given link
+            void link(std::size_t& first, Handle candidate) {
+                std::size_t added = this->free_links;
+                if (added == NO_LINK) {
+                    added = this->links.size();
+                    this->links.push_back({});
+                } else {
+                    this->free_links = this->links[added].next;
+                }
+                this->links[added] = {candidate, first};
+                first = added;
+            }
+
+            // removes the given candidate from the list starting at the given link
+            void unlink(std::size_t& first, Handle candidate) {
+                for (std::size_t* at = &first; *at != NO_LINK; at = &this->links[*at].next) {
+                    std::size_t removed = *at;
+                    if (this->links[removed].candidate == candidate) {
+                        *at = this->links[removed].next;
+                        this->links[removed].next = this->free_links;
+                        this->free_links = removed;
+                        return;
+                    }
+                }
+            }
+
+            // the first link of the given cell's list, added if there isn't one yet
+            std::size_t& cell(Cell id) {
+                auto it = std::lower_bound(
+                    this->by_cell.begin(), this->by_cell.end(), id,
+                    [](const std::pair<Cell, std::size_t>& entry, Cell cell) { return entry.first < cell; }
+                );
+                if (it == this->by_cell.end() or it->first != id) {
+                    it = this->by_cell.insert(it, {id, NO_LINK});
+                }
+                return it->second;
+            }
+        };
+
+        struct PlacedTriangle {
+            TriangleShape corners;
+            Bounds bounds;
+        };
+
+        // the vertices each queued candidate is to be built from
+        struct CandidatePair {
+            VertexID first;
+            VertexID second;
+        };
+
+        // candidates queued up for building, with coördinates kept as structure-of-arrays
+        struct CandidateBatch {
+            explicit CandidateBatch(Allocator allocator)
+              : pairs(allocator)
+              , first_x(allocator)
+              , first_y(allocator)
+              , edge_x(allocator)
+              , edge_y(allocator)
+              , third_x(allocator)
+              , third_y(allocator)
+              , bounds(allocator)
+              {
+                // batches never get any bigger than this, so building them never needs to allocate
+                this->pairs.reserve(CANDIDATE_BATCH_SIZE);
+                for (auto* column : {&this->first_x, &this->first_y, &this->edge_x, &this->edge_y, &this->third_x, &this->third_y}) {
+                    column->reserve(CANDIDATE_BATCH_SIZE);
+                }
+                this->bounds.reserve(CANDIDATE_BATCH_SIZE);
+            }
+
+            std::pmr::vector<CandidatePair> pairs;
+            std::pmr::vector<Unit> first_x;
+            std::pmr::vector<Unit> first_y;
+            std::pmr::vector<Unit> edge_x; // the first edge, from the first vertex to the second
+            std::pmr::vector<Unit> edge_y;
+            std::pmr::vector<Unit> third_x;
+            std::pmr::vector<Unit> third_y;
+            std::pmr::vector<Bounds> bounds;
+        };
+
+        // how far a search for candidates has got, so it can be paused and carried on later
+        struct SearchCursor {
+            bool paused = false;
+            bool remaining = false; // whether there are any pairs left to try
+            bool close_pairs_only = false;
+            std::size_t pair = 0; // into _close_pairs, when trying only nearby pairs
+            // otherwise, trying every vertex iv of group i against every vertex jv of group j
+            std::size_t i = 0;
+            std::size_t j = 0;
+            std::size_t iv = 0;
+            std::size_t jv = 0;
+        };
+
+        struct LiveVertex {
+            VertexID vertex;
+            Point position;
+            std::size_t first_triangle; // index of the first triangle it appeared in
+        };
+
+        VertexID add_vertex(Point position, bool eligible = true) {
+            this->_vertices.push_back(Vertex(position, eligible));
+            return this->_vertices.size() - 1;
+        }
+
+        // adds the triangle with the given vertices and corners to the drawing and publishes it to readers
+        void accept(const std::array<VertexID, 3>& vertices, const TriangleShape& corners) {
+            // any search that was cut short no longer applies
+            this->_search.paused = false;
+            std::size_t triangle = this->_placed.size();
+            for (VertexID vertex : vertices) {
+                this->_vertices.edit(vertex).add_triangle(triangle, corners, vertices, vertex);
+            }
+            this->_placed.push_back({corners, bounds_of(corners)});
+            this->_coverage.edit().add(corners);
+            this->_store.push_back(corners);
+            // keep track of every distinct eligible vertex, in the order they first appear
+            auto& live = this->_live_vertices.edit();
+            for (VertexID id : vertices) {
+                const Vertex& vertex = this->_vertices[id];
+                if (vertex.connected_triangles_count() == 1 and vertex.is_eligible()) {
+                    live.push_back({id, vertex.get_position(), triangle});
+                }
+            }
+            // this triangle may have used up all the room left around some vertices
+            std::erase_if(
+                live,
+                [&](const LiveVertex& vertex) { return not this->_vertices[vertex.vertex].is_eligible(); }
+            );
+            // scratch space for searching the live vertices grows along with them, so searches don't have to
+            reserve_geometrically(this->_vertex_groups, live.size() + 1);
+            reserve_geometrically(this->_vertex_group_ids, live.size());
+            reserve_geometrically(this->_cells, live.size());
+        }
+
+        // adds the given candidate, with a new Vertex for its third corner
+        // returns the vertices of the new triangle
+        std::array<VertexID, 3> accept(const Candidate& candidate) {
+            std::array<VertexID, 3> vertices = {
+                candidate.first, candidate.second, this->add_vertex(candidate.corners[2]),
+            };
+            this->accept(vertices, candidate.corners);
+            return vertices;
+        }
+
+        // adds the candidate with the lowest score, keeping the ranked candidates up to date
+        Step add_best_triangle(Deadline deadline, const std::stop_token& stop) {
+            if (not this->_ranking->seeded) {
+                // the first time round, every valid candidate needs ranking
+                const auto& candidates = this->get_possible_next_triangles(SIZE_MAX, deadline, stop);
+                if (this->is_search_paused()) {
+                    return Step::OUT_OF_TIME;
+                }
+                this->_ranking.edit().cell_size = this->ranking_cell_size();
+                for (const auto& candidate : candidates) {
+                    this->rank(candidate);
+                }
+                this->_ranking.edit().seeded = true;
+            }
+            if (this->_ranking->heap.empty()) {
+                return Step::FINISHED;
+            }
+            Ranking& ranking = this->_ranking.edit();
+            Handle best = ranking.heap.top();
+            Candidate candidate = ranking.candidates[best];
+            this->unrank(best);
+            this->update_ranked(this->accept(candidate), candidate.corners);
+            return Step::ADDED;
+        }
+
+        // drops every ranked candidate, so they're all found again from scratch when next needed
+        void forget_ranking() {
+            if (not this->_ranking->seeded and this->_ranking->heap.empty()) {
+                return; // nothing to forget, so don't bother copying a shared ranking just to clear it
+            }
+            Ranking& ranking = this->_ranking.edit();
+            ranking.heap.clear();
+            ranking.candidates.clear();
+            ranking.seeded = false;
+            ranking.links.clear();
+            ranking.free_links = NO_LINK;
+            ranking.by_vertex.clear();
+            ranking.by_cell.clear();
+            ranking.oversized = NO_LINK;
+        }
+
+        // cells of the ranked candidates' spatial index are about as big as the triangles being made
+        Unit ranking_cell_size() const {
+            if (std::isfinite(this->_max_edge_length) and this->_max_edge_length > 0) {
+                return this->_max_edge_length;
+            }
+            Unit screen = std::max(this->_screen_size.x, this->_screen_size.y) / RANKING_GRID_RESOLUTION;
+            // any size works, some are just quicker than others
+            return std::isfinite(screen) and screen > 0 ? screen : 1;
+        }
+
+        // the first and last cells the given bounds reach, or nothing if that's too many to index them by
+        std::optional<std::pair<Cell, Cell>> ranking_cells_of(const Bounds& bounds) const {
+            Unit cell_size = this->_ranking->cell_size;
+            Unit x0 = std::floor(bounds.min_x / cell_size);
+            Unit y0 = std::floor(bounds.min_y / cell_size);
+            Unit x1 = std::floor(bounds.max_x / cell_size);
+            Unit y1 = std::floor(bounds.max_y / cell_size);
+            // NOTE: written to be false for NaN too, and to keep the conversions below in range
+            if (
+                not ((x1 - x0 + 1) * (y1 - y0 + 1) <= MAX_RANKING_CELLS) or
+                not (std::abs(x0) < 1e15 and std::abs(y0) < 1e15)
+            ) {
+                return std::nullopt;
+            }
+            return std::make_pair(
+                Cell{(std::int64_t)x0, (std::int64_t)y0},
+                Cell{(std::int64_t)x1, (std::int64_t)y1}
+            );
+        }
+
+        // calls visit with the first link of the list of ranked candidates of every cell the given bounds reach
+        // (creating any that don't exist yet), or with that of the oversized list if there are too many
+        template <typename Visit>
+        void for_each_ranking_cell(const Bounds& bounds, Visit visit) {
+            Ranking& ranking = this->_ranking.edit();
+            auto cells = this->ranking_cells_of(bounds);
+            if (not cells) {
+                visit(ranking.oversized);
+                return;
+            }
+            for (std::int64_t y = cells->first.second; y <= cells->second.second; y++) {
+                for (std::int64_t x = cells->first.first; x <= cells->second.first; x++) {
+                    visit(ranking.cell({x, y}));
+                }
+            }
+        }
+
+        void rank(const Candidate& candidate) {
+            Ranking& ranking = this->_ranking.edit();
+            Handle h = ranking.heap.push({this->_scorer(candidate.corners), ranking.discovered++});
+            if (h == ranking.candidates.size()) {
+                ranking.candidates.push_back(candidate);
+            } else {
+                ranking.candidates[h] = candidate;
+            }
+            std::size_t vertices = std::max(candidate.first, candidate.second) + 1;
+            if (ranking.by_vertex.size() < vertices) {
+                ranking.by_vertex.resize(vertices, NO_LINK);
+            }
+            ranking.link(ranking.by_vertex[candidate.first], h);
+            ranking.link(ranking.by_vertex[candidate.second], h);
+            this->for_each_ranking_cell(
+                bounds_of(candidate.corners),
+                [&](std::size_t& first) { ranking.link(first, h); }
+            );
+        }
+
+        // removes a ranked candidate from the heap and all of its indices
+        void unrank(Handle h) {
+            Ranking& ranking = this->_ranking.edit();
+            const Candidate& candidate = ranking.candidates[h];
+            auto forget = [&](std::size_t& first) {
+                ranking.unlink(first, h);
+            };
+            forget(ranking.by_vertex[candidate.first]);
+            forget(ranking.by_vertex[candidate.second]);
+            this->for_each_ranking_cell(bounds_of(candidate.corners), forget);
+            ranking.heap.erase(h);
+        }
+
+        // a new triangle can only invalidate existing candidates, or create new ones using its new vertex
+        void update_ranked(const std::array<VertexID, 3>& newest, const TriangleShape& corners) {
+            Ranking& ranking = this->_ranking.edit();
+            // only candidates sharing a vertex with the new triangle can have had their vertices used up or
+            // joined by it, and only those whose bounds reach its cells can overlap it
+            auto& nearby = this->_ranked_nearby;
+            nearby.clear();
+            auto gather = [&](std::size_t first) {
+                for (std::size_t at = first; at != NO_LINK; at = ranking.links[at].next) {
+                    nearby.push_back(ranking.links[at].candidate);
+                }
+            };
+            for (VertexID vertex : newest) {
+                if (vertex < ranking.by_vertex.size()) {
+                    gather(ranking.by_vertex[vertex]);
+                }
+            }
+            auto cells = this->ranking_cells_of(bounds_of(corners));
+            if (cells) {
+                // NOTE: cells are sorted by x then y, so each column of them is a run which can be found directly
+                for (std::int64_t x = cells->first.first; x <= cells->second.first; x++) {
+                    auto cell = std::lower_bound(
+                        ranking.by_cell.begin(), ranking.by_cell.end(), Cell{x, cells->first.second},
+                        [](const std::pair<Cell, std::size_t>& entry, Cell id) { return entry.first < id; }
+                    );
+                    for (; cell != ranking.by_cell.end() and cell->first <= Cell{x, cells->second.second}; cell++) {
+                        gather(cell->second);
+                    }
+                }
+            } else {
+                // the new triangle is big enough to reach any of them
+                for (const auto& cell : ranking.by_cell) {
+                    gather(cell.second);
+                }
+            }
+            gather(ranking.oversized);
+            std::sort(nearby.begin(), nearby.end());
+            nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+            for (Handle h : nearby) {
+                const Candidate& candidate = ranking.candidates[h];
+                const Vertex& first = this->_vertices[candidate.first];
+                const Vertex& second = this->_vertices[candidate.second];
+                // either its vertices are used up or now share a triangle, or it overlaps the new one
+                if (
+                    not first.is_eligible() or
+                    not second.is_eligible() or
+                    first.common_to(second) or
+                    are_intersecting(candidate.corners, corners)
+                ) {
+                    this->unrank(h);
+                }
+            }
+            this->_candidates.clear();
+            for (VertexID vertex : newest) {
+                if (this->_vertices[vertex].connected_triangles_count() != 1) {
+                    continue; // not a new vertex, so any candidates it's part of are already known
+                }
+                for (const auto& other : *this->_live_vertices) {
+                    this->queue_pair(other.vertex, vertex, SIZE_MAX);
+                    this->queue_pair(vertex, other.vertex, SIZE_MAX);
+                }
+            }
+            this->flush_batch(SIZE_MAX);
+            for (const auto& candidate : this->_candidates) {
+                this->rank(candidate);
+            }
+        }
+
+        Allocator _allocator;
+        // every vertex there has ever been, by ID
+        PRIVATE::PersistentVector<Vertex> _vertices;
+        // corners and bounds of each accepted triangle, kept together for quick intersection tests
+        PRIVATE::PersistentVector<PlacedTriangle> _placed;
+        // which parts of the screen are already filled, for rejecting candidates there quickly
+        PRIVATE::CopyOnWrite<PRIVATE::CoverageGrid> _coverage;
+        // every distinct vertex of the accepted triangles still eligible, in order of appearance
+        PRIVATE::CopyOnWrite<std::pmr::vector<LiveVertex>> _live_vertices;
+        // scratch space for candidate search, kept between searches to reuse its storage
+        std::pmr::vector<Candidate> _candidates;
+        CandidateBatch _batch;
+        // scratch space for grouping _live_vertices by triangle, kept to reuse its storage
+        std::pmr::vector<std::size_t> _vertex_groups;
+        std::pmr::vector<std::size_t> _vertex_group_ids;
+        // scratch space for finding nearby pairs of vertices
+        std::pmr::vector<std::pair<Cell, std::size_t>> _cells;
+        std::pmr::vector<std::pair<std::size_t, std::size_t>> _close_pairs;
+        // scratch space for finding which ranked candidates a new triangle could affect
+        std::pmr::vector<Handle> _ranked_nearby;
+        SearchCursor _search;
+        Scorer _scorer;
+        PRIVATE::CopyOnWrite<Ranking> _ranking;
+        // copy of every accepted triangle's corners which readers can safely share
+        TriangleStore _store;
         EdgeID _branch_edge;
         Percentage _branch_point;
         Degrees _branch_angle;
+        Point _screen_origin; // top-left corner of the area to fill
         Vector _screen_size;
+        Unit _min_edge_length;
+        Unit _max_edge_length;
+        Drawing::Stats _stats;
     };
 
     Drawing::Drawing(
@@ -377,7 +1341,8 @@ namespace com::saxbophone::triangberg {
         EdgeID branch_edge,
         Percentage branch_point,
         Degrees branch_angle,
-        Vector screen_size
+        Vector screen_size,
+        std::pmr::memory_resource* resource
     ) : _builder(
             new Builder(
                 origin,
@@ -386,32 +1351,324 @@ namespace com::saxbophone::triangberg {
                 branch_edge,
                 branch_point,
                 branch_angle,
-                screen_size
+                screen_size,
+                resource
             )
         )
       , _started(false)
       , _can_add_more(true)
       {}
 
+    Drawing::Drawing(
+        std::span<const TriangleShape> seeds,
+        Vector screen_size,
+        std::pmr::memory_resource* resource
+    ) : _builder(new Builder(seeds, screen_size, resource))
+      , _started(true) // no branched triangle to add
+      , _can_add_more(true)
+      {}
+
+    Drawing::Drawing(Drawing&& other) noexcept = default;
+
+    Drawing& Drawing::operator=(Drawing&& other) noexcept = default;
+
     Drawing::~Drawing() = default;
 
+    Drawing Drawing::fork() const {
+        return Drawing(std::unique_ptr<Builder>(new Builder(*this->_builder)), this->_started, this->_can_add_more);
+    }
+
+    std::vector<Drawing> Drawing::beam_search(const Drawing& start, const BeamSearch& search) {
+        TRIANGBERG_TRACE_ZONE("Drawing::beam_search");
+        std::vector<Drawing> beam;
+        beam.push_back(start.fork());
+        for (std::size_t step = 0; step < search.steps; step++) {
+            if (std::ranges::all_of(beam, &Drawing::is_complete)) {
+                break;
+            }
+            // each drawing's forks are kept apart, so they're in the same order however they were shared out
+            std::vector<std::vector<Drawing>> forks(beam.size());
+            std::vector<std::vector<Unit>> scores(beam.size());
+            PRIVATE::parallel_for(
+                beam.size(), search.threads,
+                [&](std::size_t d) {
+                    beam[d].branch(search.branching, forks[d]);
+                    for (const Drawing& fork : forks[d]) {
+                        scores[d].push_back(search.score(fork));
+                    }
+                }
+            );
+            // keep the lowest-scored, first-found of them
+            std::vector<std::pair<Unit, Drawing*>> ranked;
+            for (std::size_t d = 0; d < beam.size(); d++) {
+                for (std::size_t f = 0; f < forks[d].size(); f++) {
+                    ranked.push_back({scores[d][f], &forks[d][f]});
+                }
+            }
+            std::ranges::stable_sort(ranked, {}, &std::pair<Unit, Drawing*>::first);
+            std::vector<Drawing> kept;
+            for (std::size_t k = 0; k < std::min(search.width, ranked.size()); k++) {
+                kept.push_back(std::move(*ranked[k].second));
+            }
+            beam = std::move(kept);
+        }
+        return beam;
+    }
+
+    std::vector<Drawing> Drawing::grow_forest(const Forest& forest, std::pmr::memory_resource* resource) {
+        TRIANGBERG_TRACE_ZONE("Drawing::grow_forest");
+        std::size_t threads = std::max((std::size_t)1, std::min(PRIVATE::thread_count(forest.threads), forest.seeds.size()));
+        // every triangle placed so far and which tree it's in, in the order placed, for the other trees to keep clear of
+        struct Placed {
+            std::size_t tree;
+            TriangleShape corners;
+        };
+        std::vector<Placed> placed;
+        struct Tree {
+            std::size_t seen = 0; // how much of placed it's kept clear of so far
+            std::size_t triangles = 0;
+            std::optional<Candidate> next;
+        };
+        std::vector<Drawing> trees;
+        std::vector<Tree> state(forest.seeds.size());
+        for (std::size_t t = 0; t < forest.seeds.size(); t++) {
+            const Seed& seed = forest.seeds[t];
+            trees.emplace_back(
+                seed.origin, seed.size, seed.rotation, seed.branch_edge, seed.branch_point, seed.branch_angle,
+                forest.screen_size, resource
+            );
+            // the initial and branched triangles
+            trees[t].grow();
+            for (const TriangleShape& triangle : trees[t].snapshot()) {
+                placed.push_back({t, triangle});
+                state[t].triangles++;
+            }
+        }
+        auto is_growing = [&](std::size_t t) {
+            return trees[t]._can_add_more and state[t].triangles < forest.max_triangles;
+        };
+        auto catch_up = [&](std::size_t t) {
+            for (; state[t].seen < placed.size(); state[t].seen++) {
+                if (placed[state[t].seen].tree != t) {
+                    trees[t]._builder->add_obstacle(placed[state[t].seen].corners);
+                }
+            }
+        };
+        // first, each tree finds its next triangle against everything placed by the start of the round
+        auto find_next = [&](std::size_t worker) {
+            for (std::size_t t = worker; t < trees.size(); t += threads) {
+                if (is_growing(t)) {
+                    catch_up(t);
+                    state[t].next = trees[t]._builder->find_next_triangle();
+                }
+            }
+        };
+        // then they're placed in seed order, each checked against those placed before it in the same round
+        // NOTE: triangles placed since only ever rule candidates out, so one that's still valid is still
+        // the first that tree would find
+        bool finished = false;
+        std::atomic<bool> failed = false; // if any worker threw, which the rest then give up after this round
+        // NOTE: the barrier needs this not to throw, so anything it does throw is kept to pass on at the end
+        std::exception_ptr placing_failed;
+        auto place_next = [&]() noexcept {
+            if (failed) {
+                finished = true;
+                return;
+            }
+            try {
+                finished = true;
+                for (std::size_t t = 0; t < trees.size(); t++) {
+                    if (not is_growing(t)) {
+                        continue;
+                    }
+                    catch_up(t);
+                    std::optional<Candidate>& next = state[t].next;
+                    if (next and not trees[t]._builder->is_still_valid(*next)) {
+                        next = trees[t]._builder->find_next_triangle();
+                    }
+                    if (not next) {
+                        trees[t]._can_add_more = false;
+                        continue;
+                    }
+                    trees[t]._builder->add_candidate(*next);
+                    placed.push_back({t, next->corners});
+                    state[t].triangles++;
+                    finished = finished and not is_growing(t);
+                }
+            } catch (...) {
+                placing_failed = std::current_exception();
+                failed = true;
+                finished = true;
+            }
+        };
+        std::barrier round_over((std::ptrdiff_t)threads, place_next);
+        PRIVATE::run_on_threads(
+            threads,
+            [&](std::size_t worker) {
+                try {
+                    while (not finished) {
+                        find_next(worker);
+                        round_over.arrive_and_wait();
+                    }
+                } catch (...) {
+                    // don't leave the others waiting for this one at the barrier
+                    failed = true;
+                    round_over.arrive_and_drop();
+                    throw;
+                }
+            }
+        );
+        if (placing_failed) {
+            std::rethrow_exception(placing_failed);
+        }
+        return trees;
+    }
+
+    Drawing::Drawing(std::unique_ptr<Builder> builder, bool started, bool can_add_more)
+      : _builder(std::move(builder))
+      , _started(started)
+      , _can_add_more(can_add_more)
+      {}
+
+    void Drawing::branch(std::size_t limit, std::vector<Drawing>& forks) {
+        if (not this->_started or not this->_can_add_more) {
+            // there's only one way to carry on from here
+            forks.push_back(std::move(*this));
+            forks.back().grow();
+            return;
+        }
+        const auto& candidates = this->_builder->get_possible_next_triangles(limit);
+        for (const Candidate& candidate : candidates) {
+            forks.push_back(this->fork());
+            forks.back()._builder->add_candidate(candidate);
+        }
+        if (forks.empty()) {
+            // nothing more can be added, so this one competes as it is
+            this->_can_add_more = false;
+            forks.push_back(std::move(*this));
+        }
+    }
+
+    void Drawing::set_bounds(Point top_left, Vector size) {
+        this->_builder->set_bounds(top_left, size);
+    }
+
+    void Drawing::set_edge_length_bounds(Unit min, Unit max) {
+        this->_builder->set_edge_length_bounds(min, max);
+    }
+
     bool Drawing::is_complete() const {
         return not this->_can_add_more;
     }
 
     void Drawing::add_triangle(std::function<std::size_t(std::size_t)>) {
+        this->grow();
+    }
+
+    Drawing::Growth Drawing::add_triangles(std::size_t max_count) {
+        Growth growth = {0, this->is_complete()};
+        while (growth.added < max_count and not growth.complete) {
+            if (this->grow()) {
+                growth.added++;
+            }
+            growth.complete = this->is_complete();
+        }
+        return growth;
+    }
+
+    Drawing::Growth Drawing::grow_until(std::chrono::steady_clock::time_point deadline) {
+        Growth growth = {0, this->is_complete()};
+        while (not growth.complete and std::chrono::steady_clock::now() < deadline) {
+            if (this->grow(deadline)) {
+                growth.added++;
+            }
+            growth.complete = this->is_complete();
+        }
+        return growth;
+    }
+
+    std::future<Drawing::Growth> Drawing::build_async(
+        const Executor& executor,
+        std::stop_token stop,
+        std::size_t max_count
+    ) {
+        // NOTE: shared, as the task has to be copyable to go in a std::function
+        auto promise = std::make_shared<std::promise<Growth>>();
+        std::future<Growth> result = promise->get_future();
+        executor([this, promise, stop = std::move(stop), max_count] {
+            TRIANGBERG_TRACE_ZONE("Drawing::build_async");
+            // whatever goes wrong (such as the scorer throwing) is for whoever waits on the future to deal with
+            try {
+                Growth growth = {0, this->is_complete()};
+                while (growth.added < max_count and not growth.complete and not stop.stop_requested()) {
+                    if (this->grow(NO_DEADLINE, stop)) {
+                        growth.added++;
+                    }
+                    growth.complete = this->is_complete();
+                }
+                promise->set_value(growth);
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return result;
+    }
+
+    Drawing::Shapes Drawing::get_shapes() const {
+        TRIANGBERG_TRACE_ZONE("get_shapes");
+        Shapes shapes;
+        for (const TriangleShape& triangle : this->snapshot()) {
+            shapes.triangles.emplace_back(triangle.begin(), triangle.end());
+        }
+        return shapes;
+    }
+
+    TriangleStore::Snapshot Drawing::snapshot() const {
+        return this->_builder->snapshot();
+    }
+
+    std::size_t Drawing::version() const {
+        return this->snapshot().size();
+    }
+
+    Drawing::Changes Drawing::changes_since(std::size_t version) const {
+        // NOTE: the version is taken from the same snapshot, so that nothing added meanwhile is missed
+        TriangleStore::Snapshot triangles = this->snapshot();
+        return {triangles.size(), triangles.since(version)};
+    }
+
+    Drawing::Stats Drawing::get_stats() const {
+        return this->_builder->get_stats();
+    }
+
+    double Drawing::get_coverage() const {
+        return this->_builder->get_coverage();
+    }
+
+    std::vector<TrianglePair> Drawing::find_intersecting_triangles() const {
+        TriangleStore::Snapshot triangles = this->snapshot();
+        return com::saxbophone::triangberg::find_intersecting_triangles(
+            std::vector<TriangleShape>(triangles.begin(), triangles.end())
+        );
+    }
+
+    void Drawing::set_scorer(Scorer scorer) {
+        this->_builder->set_scorer(std::move(scorer));
+    }
+
+    bool Drawing::grow(std::chrono::steady_clock::time_point deadline, const std::stop_token& stop) {
+        // every way of adding triangles comes through here
+        TRIANGBERG_TRACE_ZONE("Drawing::add_triangle");
         if (not this->_started) {
             // add second triangle at an angle and partway on an edge
             this->_builder->add_second_triangle(20);
             this->_started = true;
+            return true;
         } else if (this->_can_add_more) {
-            this->_can_add_more = this->_builder->add_next_triangle();
+            Builder::Step step = this->_builder->add_next_triangle(deadline, stop);
+            this->_can_add_more = step != Builder::Step::FINISHED;
+            return step == Builder::Step::ADDED;
         }
-    }
-
-    Drawing::Shapes Drawing::get_shapes() const {
-        return {
-            {}, this->_builder->get_shapes()
-        };
+        return false;
     }
 }
@@ -0,0 +1,250 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Animation.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/FrameRing.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+#include <triangberg_builder/trace.hpp>
+
+namespace {
+    using namespace com::saxbophone::triangberg;
+
+    const std::uint32_t MAGIC = 0x52475254; // "TRGR" when little-endian
+    const std::uint32_t VERSION = 1;
+    // the writer and reader each have their own counter, on separate cache lines so they don't slow each other down
+    const std::size_t CACHE_LINE = 64;
+
+    // the atomics are shared between processes, which only works for ones that are lock-free
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+    // at the start of the shared memory, followed by the slots
+    struct RingHeader {
+        std::atomic<std::uint32_t> magic; // set last by the writer, once the rest is ready
+        std::uint32_t version;
+        std::uint64_t slots;
+        std::uint64_t max_triangles;
+        std::uint64_t slot_size;
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> written; // only changed by the writer
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> read; // only changed by the reader
+        std::atomic<std::uint32_t> closed; // set by the writer when it's gone
+    };
+
+    // at the start of each slot, followed by its vertices
+    struct SlotHeader {
+        std::uint64_t number;
+        Degrees angle;
+        Percentage p;
+        Degrees base_angle;
+        std::uint64_t triangles;
+    };
+
+    std::size_t round_up(std::size_t size, std::size_t multiple) {
+        return (size + multiple - 1) / multiple * multiple;
+    }
+
+    const std::size_t SLOTS_OFFSET = round_up(sizeof(RingHeader), CACHE_LINE);
+
+    std::size_t slot_size(std::size_t max_triangles) {
+        return round_up(sizeof(SlotHeader) + max_triangles * 3 * sizeof(FrameVertex), CACHE_LINE);
+    }
+
+    RingHeader& header_of(void* memory) {
+        return *(RingHeader*)memory;
+    }
+
+    // the slot that the frame with the given number goes in
+    SlotHeader& slot_of(void* memory, std::uint64_t number) {
+        const RingHeader& header = header_of(memory);
+        return *(SlotHeader*)((std::byte*)memory + SLOTS_OFFSET + (number % header.slots) * header.slot_size);
+    }
+
+    FrameVertex* vertices_of(SlotHeader& slot) {
+        return (FrameVertex*)(&slot + 1);
+    }
+}
+
+namespace com::saxbophone::triangberg {
+    FrameRingWriter::FrameRingWriter(std::string name, std::size_t slots, std::size_t max_triangles)
+      : _name(std::move(name))
+      , _memory(nullptr)
+      , _size(SLOTS_OFFSET + std::max(slots, (std::size_t)1) * slot_size(max_triangles))
+      {
+        // a ring left behind by a writer that didn't exit cleanly can't be reused, as its reader may still be attached
+        ::shm_unlink(this->_name.c_str());
+        int fd = ::shm_open(this->_name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+        if (fd == -1) {
+            return;
+        }
+        // NOTE: this also fills it with zeroes, so no reader can see the magic number until it's set below
+        bool sized = ::ftruncate(fd, (off_t)this->_size) == 0;
+        void* memory = sized ? ::mmap(nullptr, this->_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            ::shm_unlink(this->_name.c_str());
+            return;
+        }
+        this->_memory = memory;
+        RingHeader& header = *new (memory) RingHeader;
+        header.version = VERSION;
+        header.slots = std::max(slots, (std::size_t)1);
+        header.max_triangles = max_triangles;
+        header.slot_size = slot_size(max_triangles);
+        header.written.store(0, std::memory_order_relaxed);
+        header.read.store(0, std::memory_order_relaxed);
+        header.closed.store(0, std::memory_order_relaxed);
+        header.magic.store(MAGIC, std::memory_order_release);
+    }
+
+    FrameRingWriter::~FrameRingWriter() {
+        if (this->_memory == nullptr) {
+            return;
+        }
+        header_of(this->_memory).closed.store(1, std::memory_order_release);
+        ::munmap(this->_memory, this->_size);
+        ::shm_unlink(this->_name.c_str());
+    }
+
+    bool FrameRingWriter::is_open() const {
+        return this->_memory != nullptr;
+    }
+
+    bool FrameRingWriter::is_full() const {
+        const RingHeader& header = header_of(this->_memory);
+        std::uint64_t written = header.written.load(std::memory_order_relaxed);
+        // NOTE: acquire, so that the reader's reads of the slot it gave back happen before it's written over
+        return written - header.read.load(std::memory_order_acquire) >= header.slots;
+    }
+
+    bool FrameRingWriter::write(const AnimationFrame& parameters, const Drawing& drawing) {
+        TRIANGBERG_TRACE_ZONE("FrameRingWriter::write");
+        if (this->is_full()) {
+            return false;
+        }
+        RingHeader& header = header_of(this->_memory);
+        std::uint64_t number = header.written.load(std::memory_order_relaxed);
+        SlotHeader& slot = slot_of(this->_memory, number);
+        FrameVertex* vertex = vertices_of(slot);
+        TriangleStore::Snapshot triangles = drawing.snapshot();
+        std::size_t count = std::min(triangles.size(), (std::size_t)header.max_triangles);
+        const std::array<std::array<std::uint8_t, 3>, 3> colours = {{{255, 0, 0}, {0, 255, 0}, {0, 0, 255}}};
+        for (std::size_t t = 0; t < count; t++) {
+            const TriangleShape& triangle = triangles[t];
+            for (std::size_t c = 0; c < 3; c++) {
+                *vertex++ = {
+                    (float)triangle[c].x, (float)triangle[c].y,
+                    colours[c][0], colours[c][1], colours[c][2], 255,
+                    0, 0,
+                };
+            }
+        }
+        slot.number = number;
+        slot.angle = parameters.angle;
+        slot.p = parameters.p;
+        slot.base_angle = parameters.base_angle;
+        slot.triangles = count;
+        // hands the slot over, along with everything written to it above
+        header.written.store(number + 1, std::memory_order_release);
+        return true;
+    }
+
+    FrameRingReader::FrameRingReader(const std::string& name)
+      : _memory(nullptr)
+      , _size(0)
+      {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd == -1) {
+            return;
+        }
+        struct stat status;
+        bool big_enough = ::fstat(fd, &status) == 0 and (std::size_t)status.st_size >= SLOTS_OFFSET;
+        void* memory = big_enough
+            ? ::mmap(nullptr, (std::size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            return;
+        }
+        // the writer may not have finished setting it up yet, or it may be something else entirely
+        const RingHeader& header = header_of(memory);
+        if (
+            header.magic.load(std::memory_order_acquire) != MAGIC or header.version != VERSION
+            or header.slots == 0 or header.slot_size != slot_size(header.max_triangles)
+            or SLOTS_OFFSET + header.slots * header.slot_size != (std::size_t)status.st_size
+        ) {
+            ::munmap(memory, (std::size_t)status.st_size);
+            return;
+        }
+        this->_memory = memory;
+        this->_size = (std::size_t)status.st_size;
+    }
+
+    FrameRingReader::~FrameRingReader() {
+        if (this->_memory != nullptr) {
+            ::munmap(this->_memory, this->_size);
+        }
+    }
+
+    bool FrameRingReader::is_open() const {
+        return this->_memory != nullptr;
+    }
+
+    std::size_t FrameRingReader::available() const {
+        const RingHeader& header = header_of(this->_memory);
+        // NOTE: acquire, so that everything the writer put in the slots it handed over can be seen
+        std::uint64_t written = header.written.load(std::memory_order_acquire);
+        return (std::size_t)(written - header.read.load(std::memory_order_relaxed));
+    }
+
+    std::optional<RingFrame> FrameRingReader::peek() const {
+        if (this->available() == 0) {
+            return std::nullopt;
+        }
+        const RingHeader& header = header_of(this->_memory);
+        std::uint64_t number = header.read.load(std::memory_order_relaxed);
+        SlotHeader& slot = slot_of(this->_memory, number);
+        // a writer that's gone wrong mustn't be able to make us read past the end of the slot
+        std::size_t triangles = (std::size_t)std::min(slot.triangles, header.max_triangles);
+        return RingFrame{
+            slot.number,
+            {slot.angle, slot.p, slot.base_angle},
+            {vertices_of(slot), triangles * 3},
+        };
+    }
+
+    void FrameRingReader::pop() {
+        if (this->available() == 0) {
+            return;
+        }
+        RingHeader& header = header_of(this->_memory);
+        // hands the slot back, once everything read from it has been read
+        header.read.store(header.read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool FrameRingReader::is_closed() const {
+        return header_of(this->_memory).closed.load(std::memory_order_acquire) != 0;
+    }
+}
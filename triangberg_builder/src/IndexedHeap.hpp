@@ -0,0 +1,170 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_INDEXED_HEAP_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_INDEXED_HEAP_HPP
+
+#include <cstddef>
+
+#include <functional>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    /**
+     * @brief Binary min-heap of keys, each of which is addressed by a stable
+     * handle so that it can be removed or re-keyed in O(log n) wherever it is
+     * in the heap.
+     * @details Handles are small integers which are recycled once erased, so
+     * callers can use them to index their own arrays of per-entry data.
+     */
+    template <typename Key, typename Compare = std::less<Key>>
+    class IndexedHeap {
+    public:
+        typedef std::size_t Handle;
+
+        explicit IndexedHeap(std::pmr::polymorphic_allocator<> allocator = {})
+          : _heap(allocator)
+          , _positions(allocator)
+          , _keys(allocator)
+          , _free(allocator)
+          {}
+
+        // copies other, but using the given allocator instead of its one
+        IndexedHeap(const IndexedHeap& other, std::pmr::polymorphic_allocator<> allocator)
+          : _heap(other._heap, allocator)
+          , _positions(other._positions, allocator)
+          , _keys(other._keys, allocator)
+          , _free(other._free, allocator)
+          , _compare(other._compare)
+          {}
+
+        bool empty() const {
+            return this->_heap.empty();
+        }
+
+        std::size_t size() const {
+            return this->_heap.size();
+        }
+
+        // upper bound (exclusive) of all handles that have ever been given out
+        std::size_t capacity() const {
+            return this->_keys.size();
+        }
+
+        bool contains(Handle handle) const {
+            return handle < this->_positions.size() and this->_positions[handle] != NOWHERE;
+        }
+
+        const Key& key(Handle handle) const {
+            return this->_keys[handle];
+        }
+
+        // handle of the smallest key
+        Handle top() const {
+            return this->_heap.front();
+        }
+
+        Handle push(Key key) {
+            Handle handle;
+            if (not this->_free.empty()) {
+                handle = this->_free.back();
+                this->_free.pop_back();
+                this->_keys[handle] = std::move(key);
+            } else {
+                handle = this->_keys.size();
+                this->_keys.push_back(std::move(key));
+                this->_positions.push_back(NOWHERE);
+            }
+            this->_positions[handle] = this->_heap.size();
+            this->_heap.push_back(handle);
+            this->sift_up(this->_heap.size() - 1);
+            return handle;
+        }
+
+        void erase(Handle handle) {
+            std::size_t position = this->_positions[handle];
+            std::size_t last = this->_heap.size() - 1;
+            if (position != last) {
+                this->swap(position, last);
+            }
+            this->_heap.pop_back();
+            this->_positions[handle] = NOWHERE;
+            this->_free.push_back(handle);
+            // the entry moved into the hole may need to go either way
+            if (position < this->_heap.size()) {
+                Handle moved = this->_heap[position];
+                this->sift_up(position);
+                this->sift_down(this->_positions[moved]);
+            }
+        }
+
+        void update(Handle handle, Key key) {
+            this->_keys[handle] = std::move(key);
+            this->sift_up(this->_positions[handle]);
+            this->sift_down(this->_positions[handle]);
+        }
+
+        void clear() {
+            this->_heap.clear();
+            this->_positions.clear();
+            this->_keys.clear();
+            this->_free.clear();
+        }
+
+    private:
+        static constexpr std::size_t NOWHERE = (std::size_t)-1;
+
+        bool less(std::size_t a, std::size_t b) const {
+            return this->_compare(this->_keys[this->_heap[a]], this->_keys[this->_heap[b]]);
+        }
+
+        void swap(std::size_t a, std::size_t b) {
+            std::swap(this->_heap[a], this->_heap[b]);
+            this->_positions[this->_heap[a]] = a;
+            this->_positions[this->_heap[b]] = b;
+        }
+
+        void sift_up(std::size_t position) {
+            while (position > 0) {
+                std::size_t parent = (position - 1) / 2;
+                if (not this->less(position, parent)) {
+                    break;
+                }
+                this->swap(position, parent);
+                position = parent;
+            }
+        }
+
+        void sift_down(std::size_t position) {
+            while (true) {
+                std::size_t smallest = position;
+                std::size_t left = 2 * position + 1;
+                std::size_t right = left + 1;
+                if (left < this->_heap.size() and this->less(left, smallest)) {
+                    smallest = left;
+                }
+                if (right < this->_heap.size() and this->less(right, smallest)) {
+                    smallest = right;
+                }
+                if (smallest == position) {
+                    break;
+                }
+                this->swap(position, smallest);
+                position = smallest;
+            }
+        }
+
+        std::pmr::vector<Handle> _heap; // handles in heap order
+        std::pmr::vector<std::size_t> _positions; // where each handle is in _heap
+        std::pmr::vector<Key> _keys; // key of each handle
+        std::pmr::vector<Handle> _free; // erased handles ready for reuse
+        Compare _compare;
+    };
+}
+
+#endif // include guard
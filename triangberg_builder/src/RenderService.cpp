@@ -0,0 +1,506 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/RenderService.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+#include <triangberg_builder/Vector.hpp>
+#include <triangberg_builder/trace.hpp>
+
+#include "parallel.hpp"
+#include "raster.hpp"
+
+namespace {
+    using namespace com::saxbophone::triangberg;
+
+    const std::uint32_t MAGIC = 0x42475254; // "TRGB" when little-endian
+    const std::uint8_t VERSION = 1;
+    const std::uint8_t STATUS_OK = 0;
+    const std::uint8_t STATUS_BAD_REQUEST = 1;
+    const std::uint8_t STATUS_FAILED = 2;
+    const std::size_t RESPONSE_HEADER_SIZE = 1 + 8;
+    // far beyond any sensible drawing, but small enough that coördinates derived from it stay well within range
+    const Unit MAX_MAGNITUDE = 1e9;
+    // how long a client can stall partway through sending a request or receiving a response
+    const timeval IO_TIMEOUT = {5, 0};
+
+    // appends the raw bytes of a value
+    template <typename T>
+    void put(std::vector<std::uint8_t>& bytes, T value) {
+        std::uint8_t raw[sizeof(T)];
+        std::memcpy(raw, &value, sizeof(T));
+        bytes.insert(bytes.end(), raw, raw + sizeof(T));
+    }
+
+    // reads a value from the raw bytes at the given offset, moving the offset past it
+    template <typename T>
+    T get(std::span<const std::uint8_t> bytes, std::size_t& offset) {
+        T value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    // reads or writes exactly size bytes, unless the connection fails or is closed
+    bool read_all(int fd, std::uint8_t* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t got = ::read(fd, data, size);
+            if (got <= 0) {
+                return false;
+            }
+            data += got;
+            size -= (std::size_t)got;
+        }
+        return true;
+    }
+
+    bool write_all(int fd, const std::uint8_t* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= (std::size_t)sent;
+        }
+        return true;
+    }
+
+    bool send_response(int fd, std::uint8_t status, std::span<const std::uint8_t> payload) {
+        std::vector<std::uint8_t> header;
+        put(header, status);
+        put(header, (std::uint64_t)payload.size());
+        return write_all(fd, header.data(), header.size()) and write_all(fd, payload.data(), payload.size());
+    }
+
+    bool make_address(const std::string& path, sockaddr_un& address) {
+        if (path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+}
+
+namespace com::saxbophone::triangberg {
+    std::vector<std::uint8_t> RenderService::Request::encode() const {
+        std::vector<std::uint8_t> bytes;
+        bytes.reserve(ENCODED_SIZE);
+        put(bytes, MAGIC);
+        put(bytes, VERSION);
+        put(bytes, (std::uint8_t)this->format);
+        put(bytes, (std::uint16_t)0);
+        put(bytes, this->origin.x);
+        put(bytes, this->origin.y);
+        put(bytes, this->size);
+        put(bytes, this->rotation);
+        put(bytes, this->branch_point);
+        put(bytes, this->branch_angle);
+        put(bytes, this->screen_size.x);
+        put(bytes, this->screen_size.y);
+        put(bytes, (std::uint64_t)this->branch_edge);
+        put(bytes, this->max_triangles);
+        put(bytes, (std::uint32_t)0);
+        return bytes;
+    }
+
+    std::optional<RenderService::Request> RenderService::Request::decode(std::span<const std::uint8_t> bytes) {
+        if (bytes.size() != ENCODED_SIZE) {
+            return std::nullopt;
+        }
+        std::size_t offset = 0;
+        if (get<std::uint32_t>(bytes, offset) != MAGIC or get<std::uint8_t>(bytes, offset) != VERSION) {
+            return std::nullopt;
+        }
+        std::uint8_t format = get<std::uint8_t>(bytes, offset);
+        if (format > (std::uint8_t)Format::RASTER) {
+            return std::nullopt;
+        }
+        offset += 2; // padding
+        Request request;
+        request.format = (Format)format;
+        request.origin.x = get<Unit>(bytes, offset);
+        request.origin.y = get<Unit>(bytes, offset);
+        request.size = get<Unit>(bytes, offset);
+        request.rotation = get<Unit>(bytes, offset);
+        request.branch_point = get<Unit>(bytes, offset);
+        request.branch_angle = get<Unit>(bytes, offset);
+        request.screen_size.x = get<Unit>(bytes, offset);
+        request.screen_size.y = get<Unit>(bytes, offset);
+        std::uint64_t branch_edge = get<std::uint64_t>(bytes, offset);
+        if (branch_edge >= 3) {
+            return std::nullopt;
+        }
+        request.branch_edge = (EdgeID)branch_edge;
+        request.max_triangles = get<std::uint32_t>(bytes, offset);
+        // rasters are as big as the screen, so don't let anyone ask for a ridiculous one
+        if (
+            not (request.screen_size.x >= 0 and request.screen_size.x <= 16384) or
+            not (request.screen_size.y >= 0 and request.screen_size.y <= 16384)
+        ) {
+            return std::nullopt;
+        }
+        // nor for anything that can't be drawn, which would otherwise end up as garbage pixel coördinates
+        for (
+            Unit value : {
+                request.origin.x, request.origin.y, request.size, request.rotation,
+                request.branch_point, request.branch_angle,
+            }
+        ) {
+            if (not (std::abs(value) <= MAX_MAGNITUDE)) {
+                return std::nullopt; // also catches NaN
+            }
+        }
+        return request;
+    }
+
+    RenderService::RenderService(std::string socket_path, std::size_t threads, std::size_t cache_size)
+      : _socket_path(std::move(socket_path))
+      , _cache_size(cache_size)
+      , _listener(-1)
+      , _wake{-1, -1}
+      , _builds(0)
+      , _stopping(false)
+      {
+        sockaddr_un address;
+        if (not make_address(this->_socket_path, address) or ::pipe2(this->_wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+            return;
+        }
+        this->_listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (this->_listener == -1) {
+            return;
+        }
+        ::unlink(this->_socket_path.c_str());
+        if (
+            ::bind(this->_listener, (const sockaddr*)&address, sizeof(address)) != 0 or
+            ::listen(this->_listener, SOMAXCONN) != 0
+        ) {
+            ::close(this->_listener);
+            this->_listener = -1;
+            return;
+        }
+        threads = PRIVATE::thread_count(threads);
+        for (std::size_t i = 0; i < threads; i++) {
+            this->_workers.emplace_back(&RenderService::work, this);
+        }
+        this->_poller = std::thread(&RenderService::poll_connections, this);
+    }
+
+    RenderService::~RenderService() {
+        {
+            std::lock_guard lock(this->_mutex);
+            this->_stopping = true;
+            // wake up any workers blocked reading from their clients
+            for (int connection : this->_serving) {
+                ::shutdown(connection, SHUT_RDWR);
+            }
+        }
+        this->wake_poller();
+        this->_connection_available.notify_all();
+        if (this->_poller.joinable()) {
+            this->_poller.join();
+        }
+        for (auto& worker : this->_workers) {
+            worker.join();
+        }
+        for (int connection : this->_connections) {
+            ::close(connection);
+        }
+        for (int connection : this->_idle) {
+            ::close(connection);
+        }
+        if (this->_listener != -1) {
+            ::close(this->_listener);
+            ::unlink(this->_socket_path.c_str());
+        }
+        for (int fd : this->_wake) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+        }
+    }
+
+    bool RenderService::is_listening() const {
+        return this->_listener != -1;
+    }
+
+    std::size_t RenderService::builds() const {
+        std::lock_guard lock(this->_mutex);
+        return this->_builds;
+    }
+
+    std::vector<std::uint8_t> RenderService::render(const Request& request) {
+        TRIANGBERG_TRACE_ZONE("RenderService::render");
+        Drawing drawing(
+            request.origin, request.size, request.rotation, request.branch_edge,
+            request.branch_point, request.branch_angle, request.screen_size
+        );
+        drawing.add_triangles(request.max_triangles);
+        TriangleStore::Snapshot triangles = drawing.snapshot();
+        std::vector<std::uint8_t> payload;
+        if (request.format == Format::GEOMETRY) {
+            payload.reserve(4 + triangles.size() * sizeof(TriangleShape));
+            put(payload, (std::uint32_t)triangles.size());
+            for (const TriangleShape& triangle : triangles) {
+                for (Point corner : triangle) {
+                    put(payload, corner.x);
+                    put(payload, corner.y);
+                }
+            }
+        } else {
+            Raster raster = {
+                (std::uint32_t)request.screen_size.x,
+                (std::uint32_t)request.screen_size.y,
+                {},
+            };
+            raster.pixels.resize((std::size_t)raster.width * raster.height);
+            for (const TriangleShape& triangle : triangles) {
+                PRIVATE::fill_triangle(raster.pixels, raster.width, raster.height, triangle);
+            }
+            payload.reserve(8 + raster.pixels.size());
+            put(payload, raster.width);
+            put(payload, raster.height);
+            payload.insert(payload.end(), raster.pixels.begin(), raster.pixels.end());
+        }
+        return payload;
+    }
+
+    std::optional<std::vector<std::uint8_t>> RenderService::fetch(const std::string& socket_path, const Request& request) {
+        sockaddr_un address;
+        if (not make_address(socket_path, address)) {
+            return std::nullopt;
+        }
+        int connection = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (connection == -1) {
+            return std::nullopt;
+        }
+        std::optional<std::vector<std::uint8_t>> payload;
+        std::vector<std::uint8_t> sending = request.encode();
+        std::uint8_t header[RESPONSE_HEADER_SIZE];
+        if (
+            ::connect(connection, (const sockaddr*)&address, sizeof(address)) == 0 and
+            write_all(connection, sending.data(), sending.size()) and
+            read_all(connection, header, sizeof(header))
+        ) {
+            std::size_t offset = 0;
+            std::uint8_t status = get<std::uint8_t>(header, offset);
+            std::uint64_t size = get<std::uint64_t>(header, offset);
+            std::vector<std::uint8_t> received(size);
+            if (read_all(connection, received.data(), received.size()) and status == STATUS_OK) {
+                payload = std::move(received);
+            }
+        }
+        ::close(connection);
+        return payload;
+    }
+
+    std::optional<std::vector<TriangleShape>> RenderService::decode_geometry(std::span<const std::uint8_t> payload) {
+        if (payload.size() < 4) {
+            return std::nullopt;
+        }
+        std::size_t offset = 0;
+        std::uint32_t count = get<std::uint32_t>(payload, offset);
+        if (payload.size() != 4 + (std::size_t)count * 6 * sizeof(Unit)) {
+            return std::nullopt;
+        }
+        std::vector<TriangleShape> triangles(count);
+        for (TriangleShape& triangle : triangles) {
+            for (Point& corner : triangle) {
+                corner.x = get<Unit>(payload, offset);
+                corner.y = get<Unit>(payload, offset);
+            }
+        }
+        return triangles;
+    }
+
+    std::optional<RenderService::Raster> RenderService::decode_raster(std::span<const std::uint8_t> payload) {
+        if (payload.size() < 8) {
+            return std::nullopt;
+        }
+        std::size_t offset = 0;
+        Raster raster;
+        raster.width = get<std::uint32_t>(payload, offset);
+        raster.height = get<std::uint32_t>(payload, offset);
+        if (payload.size() != 8 + (std::size_t)raster.width * raster.height) {
+            return std::nullopt;
+        }
+        raster.pixels.assign(payload.begin() + 8, payload.end());
+        return raster;
+    }
+
+    void RenderService::wake_poller() {
+        if (this->_wake[1] != -1) {
+            std::uint8_t wake = 0;
+            (void)::write(this->_wake[1], &wake, 1);
+        }
+    }
+
+    void RenderService::poll_connections() {
+        std::vector<pollfd> waiting;
+        while (true) {
+            waiting = {
+                {this->_listener, POLLIN, 0},
+                {this->_wake[0], POLLIN, 0},
+            };
+            {
+                std::lock_guard lock(this->_mutex);
+                if (this->_stopping) {
+                    return;
+                }
+                for (int connection : this->_idle) {
+                    waiting.push_back({connection, POLLIN, 0});
+                }
+            }
+            if (::poll(waiting.data(), waiting.size(), -1) < 0) {
+                continue; // interrupted
+            }
+            if (waiting[1].revents != 0) {
+                // stopping, or the set of idle connections changed, which the next time round picks up
+                std::uint8_t drained[64];
+                while (::read(this->_wake[0], drained, sizeof(drained)) > 0) {}
+            }
+            {
+                std::lock_guard lock(this->_mutex);
+                // anything which has sent something (or hung up) needs a worker to deal with it
+                for (std::size_t i = 2; i < waiting.size(); i++) {
+                    if (waiting[i].revents != 0) {
+                        this->_idle.erase(waiting[i].fd);
+                        this->_connections.push_back(waiting[i].fd);
+                        this->_connection_available.notify_one();
+                    }
+                }
+            }
+            if (waiting[0].revents != 0) {
+                int connection = ::accept4(this->_listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (connection != -1) {
+                    ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &IO_TIMEOUT, sizeof(IO_TIMEOUT));
+                    ::setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &IO_TIMEOUT, sizeof(IO_TIMEOUT));
+                    std::lock_guard lock(this->_mutex);
+                    this->_idle.insert(connection);
+                }
+            }
+        }
+    }
+
+    void RenderService::work() {
+        std::unique_lock lock(this->_mutex);
+        while (true) {
+            this->_connection_available.wait(lock, [&] { return this->_stopping or not this->_connections.empty(); });
+            if (this->_stopping) {
+                return;
+            }
+            int connection = this->_connections.front();
+            this->_connections.pop_front();
+            this->_serving.insert(connection);
+            lock.unlock();
+            bool keep_open = this->serve(connection);
+            lock.lock();
+            this->_serving.erase(connection);
+            if (keep_open and not this->_stopping) {
+                // hand it back to wait for its next request without holding up this worker
+                this->_idle.insert(connection);
+                this->wake_poller();
+            } else {
+                ::close(connection);
+            }
+        }
+    }
+
+    bool RenderService::serve(int connection) {
+        std::uint8_t received[Request::ENCODED_SIZE];
+        if (not read_all(connection, received, sizeof(received))) {
+            return false; // closed, or stalled partway through
+        }
+        std::optional<Request> request = Request::decode(received);
+        if (not request) {
+            // can't tell where the next request would start, so give up on this client
+            send_response(connection, STATUS_BAD_REQUEST, {});
+            return false;
+        }
+        Payload payload = this->respond(*request);
+        if (not payload) {
+            return send_response(connection, STATUS_FAILED, {});
+        }
+        return send_response(connection, STATUS_OK, *payload);
+    }
+
+    RenderService::Payload RenderService::respond(const Request& request) {
+        Key key = request.encode();
+        std::promise<Payload> building;
+        std::shared_future<Payload> payload;
+        bool build_here = false;
+        {
+            std::lock_guard lock(this->_mutex);
+            auto cached = this->_cache.find(key);
+            auto in_progress = this->_building.find(key);
+            if (cached != this->_cache.end()) {
+                this->_recency.splice(this->_recency.begin(), this->_recency, cached->second.recency);
+                return cached->second.payload;
+            } else if (in_progress != this->_building.end()) {
+                payload = in_progress->second;
+            } else {
+                build_here = true;
+                payload = building.get_future().share();
+                this->_builds++;
+                this->_building[key] = payload;
+            }
+        }
+        if (build_here) {
+            Payload built;
+            try {
+                built = std::make_shared<const std::vector<std::uint8_t>>(render(request));
+                building.set_value(built);
+            } catch (...) {
+                // everyone waiting on this build fails too, but later requests get to try again
+                building.set_exception(std::current_exception());
+            }
+            std::lock_guard lock(this->_mutex);
+            this->_building.erase(key);
+            if (built) {
+                this->_recency.push_front(key);
+                this->_cache[key] = {built, this->_recency.begin()};
+                // forget the least recently used, which are all finished
+                while (this->_cache.size() > this->_cache_size) {
+                    this->_cache.erase(this->_recency.back());
+                    this->_recency.pop_back();
+                }
+            }
+        }
+        try {
+            return payload.get();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,286 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/StreamingCanvas.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleSink.hpp>
+#include <triangberg_builder/Vector.hpp>
+#include <triangberg_builder/trace.hpp>
+
+#include "tiling.hpp"
+
+namespace {
+    using namespace com::saxbophone::triangberg;
+    using PRIVATE::growth_order;
+    using PRIVATE::ring_of;
+    using PRIVATE::TileID;
+
+    // the tile after this one in growth order
+    TileID next_in_growth_order(TileID id) {
+        std::int64_t ring = ring_of(id);
+        if (ring == 0) {
+            return {-1, -1};
+        }
+        bool on_side = id.x == -ring or id.x == ring; // whole column of the ring, not just its ends
+        if (on_side and id.y < ring) {
+            return {id.x, id.y + 1};
+        }
+        if (not on_side and id.y == -ring) {
+            return {id.x, ring};
+        }
+        if (id.x < ring) {
+            return {id.x + 1, -ring};
+        }
+        return {-(ring + 1), -(ring + 1)};
+    }
+}
+
+namespace com::saxbophone::triangberg {
+    StreamingCanvas::StreamingCanvas(
+        Point origin,
+        Unit size,
+        Degrees rotation,
+        EdgeID branch_edge,
+        Percentage branch_point,
+        Degrees branch_angle,
+        Vector tile_size,
+        std::int64_t rings,
+        TriangleSink& sink,
+        std::filesystem::path spill_path,
+        std::size_t resident_limit,
+        std::size_t tile_limit
+    )
+      : _origin(origin)
+      , _size(size)
+      , _rotation(rotation)
+      , _branch_edge(branch_edge)
+      , _branch_point(branch_point)
+      , _branch_angle(branch_angle)
+      , _tile_size(tile_size)
+      , _tile_limit(tile_limit)
+      , _rings(rings)
+      , _sink(sink)
+      , _spill_path(std::move(spill_path))
+      , _spill(this->_spill_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)
+      , _spill_size(0)
+      , _resident_limit(resident_limit)
+      , _next{0, 0}
+      , _done(rings < 0)
+      , _tiles_grown(0)
+      , _tiles_streamed(0)
+      , _failed(false)
+      {
+        if (not this->_spill.is_open()) {
+            this->fail();
+        }
+    }
+
+    StreamingCanvas::~StreamingCanvas() {
+        this->_spill.close();
+        std::error_code ignored;
+        std::filesystem::remove(this->_spill_path, ignored);
+    }
+
+    bool StreamingCanvas::grow_next() {
+        if (this->_done) {
+            return false;
+        }
+        TRIANGBERG_TRACE_ZONE("StreamingCanvas::grow_next");
+        TileID id = this->_next;
+        // dependencies always come earlier in growth order, so are all grown already
+        std::vector<TriangleShape> seeds;
+        for (TileID dependency : PRIVATE::dependencies_of(id)) {
+            const auto& triangles = this->load(dependency);
+            seeds.insert(seeds.end(), triangles.begin(), triangles.end());
+        }
+        if (this->_failed) {
+            return false;
+        }
+        std::vector<TriangleShape> triangles = this->tiling().grow(id, seeds);
+        // write it straight out, so that it can be dropped from memory whenever
+        this->_spill.seekp((std::streamoff)this->_spill_size);
+        this->_spill.write(
+            reinterpret_cast<const char*>(triangles.data()),
+            (std::streamsize)(triangles.size() * sizeof(TriangleShape))
+        );
+        if (not this->_spill) {
+            this->fail();
+            return false;
+        }
+        this->_tiles[id] = {this->_spill_size, triangles.size(), false};
+        this->_spill_size += triangles.size() * sizeof(TriangleShape);
+        this->keep_resident(id, std::move(triangles));
+        this->_tiles_grown++;
+        // tiles are finished once all their neighbours are grown, which may be as of this one
+        std::vector<TileID> affected = PRIVATE::neighbours_of(id);
+        affected.push_back(id);
+        std::sort(
+            affected.begin(), affected.end(),
+            [](TileID a, TileID b) { return growth_order(a) < growth_order(b); }
+        );
+        for (TileID tile : affected) {
+            auto state = this->_tiles.find(tile);
+            if (state == this->_tiles.end() or state->second.streamed) {
+                continue;
+            }
+            bool finished = std::ranges::all_of(
+                PRIVATE::neighbours_of(tile),
+                [&](TileID neighbour) {
+                    return not this->in_range(neighbour) or growth_order(neighbour) <= growth_order(id);
+                }
+            );
+            if (finished) {
+                this->stream_out(tile);
+            }
+        }
+        if (this->_failed) {
+            return false;
+        }
+        for (TileID tile : affected) {
+            this->forget_finished(tile, id);
+        }
+        this->_next = next_in_growth_order(id);
+        if (not this->in_range(this->_next)) {
+            this->_done = true;
+            this->_sink.finish();
+            if (this->_sink.has_failed()) {
+                this->fail();
+            }
+        }
+        return not this->_done;
+    }
+
+    void StreamingCanvas::grow_all() {
+        while (this->grow_next()) {}
+    }
+
+    std::size_t StreamingCanvas::tiles_grown() const {
+        return this->_tiles_grown;
+    }
+
+    std::size_t StreamingCanvas::tiles_streamed() const {
+        return this->_tiles_streamed;
+    }
+
+    std::size_t StreamingCanvas::resident_tiles() const {
+        return this->_resident.size();
+    }
+
+    bool StreamingCanvas::has_failed() const {
+        return this->_failed;
+    }
+
+    PRIVATE::Tiling StreamingCanvas::tiling() const {
+        return {
+            this->_origin, this->_size, this->_rotation, this->_branch_edge,
+            this->_branch_point, this->_branch_angle, this->_tile_size, this->_tile_limit,
+        };
+    }
+
+    bool StreamingCanvas::in_range(TileID id) const {
+        return ring_of(id) <= this->_rings;
+    }
+
+    const std::vector<TriangleShape>& StreamingCanvas::load(TileID id) {
+        auto resident = this->_resident.find(id);
+        if (resident != this->_resident.end()) {
+            auto recency = std::find(this->_recency.begin(), this->_recency.end(), id);
+            this->_recency.splice(this->_recency.begin(), this->_recency, recency);
+            return resident->second;
+        }
+        const Tile& tile = this->_tiles.at(id);
+        this->_loaded.resize(tile.count);
+        this->_spill.seekg((std::streamoff)tile.offset);
+        this->_spill.read(
+            reinterpret_cast<char*>(this->_loaded.data()),
+            (std::streamsize)(tile.count * sizeof(TriangleShape))
+        );
+        if (not this->_spill) {
+            this->fail();
+            this->_loaded.clear();
+        }
+        return this->_loaded;
+    }
+
+    void StreamingCanvas::fail() {
+        this->_failed = true;
+        this->_done = true;
+    }
+
+    void StreamingCanvas::keep_resident(TileID id, std::vector<TriangleShape> triangles) {
+        if (this->_resident_limit == 0) {
+            return;
+        }
+        while (this->_resident.size() >= this->_resident_limit) {
+            this->_resident.erase(this->_recency.back());
+            this->_recency.pop_back();
+        }
+        this->_resident[id] = std::move(triangles);
+        this->_recency.push_front(id);
+    }
+
+    void StreamingCanvas::stream_out(TileID id) {
+        // NOTE: tiles out of range were never grown, so don't have any triangles
+        std::vector<TriangleShape> triangles = this->load(id);
+        std::vector<TriangleShape> surroundings = triangles;
+        for (TileID neighbour : PRIVATE::neighbours_of(id)) {
+            if (this->in_range(neighbour)) {
+                const auto& theirs = this->load(neighbour);
+                surroundings.insert(surroundings.end(), theirs.begin(), theirs.end());
+            }
+        }
+        if (this->_failed) {
+            return; // better to stream nothing than a tile missing some of its triangles
+        }
+        this->_sink.write({id, this->tiling().corner_of(id), this->_tile_size, triangles, surroundings});
+        if (this->_sink.has_failed()) {
+            this->fail();
+            return;
+        }
+        this->_tiles.at(id).streamed = true;
+        this->_tiles_streamed++;
+    }
+
+    void StreamingCanvas::forget_finished(TileID id, TileID latest) {
+        std::vector<TileID> candidates = PRIVATE::neighbours_of(id);
+        candidates.push_back(id);
+        auto is_streamed = [&](TileID tile) {
+            if (not this->in_range(tile)) {
+                return true; // never will be, but nothing needs it
+            }
+            auto state = this->_tiles.find(tile);
+            if (state != this->_tiles.end()) {
+                return state->second.streamed;
+            }
+            // it's either not grown yet, or was streamed and has already been forgotten
+            return growth_order(tile) <= growth_order(latest);
+        };
+        for (TileID tile : candidates) {
+            // a tile is needed to grow and stream out its neighbours, so can only go once they all have
+            if (
+                this->_tiles.contains(tile) and is_streamed(tile) and
+                std::ranges::all_of(PRIVATE::neighbours_of(tile), is_streamed)
+            ) {
+                this->_tiles.erase(tile);
+                if (this->_resident.erase(tile) > 0) {
+                    this->_recency.remove(tile);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,248 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+#include "parallel.hpp"
+#include "tiling.hpp"
+
+namespace com::saxbophone::triangberg {
+    using PRIVATE::growth_order;
+
+    TiledCanvas::TiledCanvas(
+        Point origin,
+        Unit size,
+        Degrees rotation,
+        EdgeID branch_edge,
+        Percentage branch_point,
+        Degrees branch_angle,
+        Vector tile_size,
+        std::size_t threads,
+        std::size_t tile_limit
+    )
+      : _origin(origin)
+      , _size(size)
+      , _rotation(rotation)
+      , _branch_edge(branch_edge)
+      , _branch_point(branch_point)
+      , _branch_angle(branch_angle)
+      , _tile_size(tile_size)
+      , _tile_limit(tile_limit)
+      , _tiles_grown(0)
+      , _stopping(false)
+      {
+        threads = PRIVATE::thread_count(threads);
+        for (std::size_t i = 0; i < threads; i++) {
+            this->_workers.emplace_back(&TiledCanvas::work, this);
+        }
+    }
+
+    TiledCanvas::~TiledCanvas() {
+        {
+            std::lock_guard lock(this->_mutex);
+            this->_stopping = true;
+        }
+        this->_work_available.notify_all();
+        for (auto& worker : this->_workers) {
+            worker.join();
+        }
+    }
+
+    TiledCanvas::TileID TiledCanvas::tile_at(Point point) const {
+        return this->tiling().tile_at(point);
+    }
+
+    void TiledCanvas::request(Point top_left, Vector size) {
+        std::vector<TileID> needed = this->tiles_for(top_left, size);
+        {
+            std::lock_guard lock(this->_mutex);
+            for (TileID id : needed) {
+                this->schedule(id);
+            }
+        }
+        this->_work_available.notify_all();
+    }
+
+    bool TiledCanvas::is_ready(Point top_left, Vector size) const {
+        std::vector<TileID> needed = this->tiles_for(top_left, size);
+        std::lock_guard lock(this->_mutex);
+        for (TileID id : needed) {
+            auto tile = this->_tiles.find(id);
+            if (tile == this->_tiles.end() or not tile->second.done) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void TiledCanvas::wait(Point top_left, Vector size) {
+        this->request(top_left, size);
+        std::vector<TileID> needed = this->tiles_for(top_left, size);
+        std::unique_lock lock(this->_mutex);
+        for (TileID id : needed) {
+            // all needed tiles were scheduled by request() above
+            const Tile& tile = this->_tiles.at(id);
+            this->_tile_done.wait(lock, [&] { return tile.done; });
+            if (tile.failure) {
+                std::rethrow_exception(tile.failure);
+            }
+        }
+    }
+
+    std::vector<TriangleShape> TiledCanvas::get_triangles(Point top_left, Vector size) const {
+        std::vector<TriangleShape> triangles;
+        std::vector<TileID> needed = this->tiles_for(top_left, size);
+        // return them in the order they were grown in
+        std::sort(
+            needed.begin(), needed.end(),
+            [](TileID a, TileID b) { return growth_order(a) < growth_order(b); }
+        );
+        std::lock_guard lock(this->_mutex);
+        for (TileID id : needed) {
+            auto tile = this->_tiles.find(id);
+            if (tile != this->_tiles.end() and tile->second.failure) {
+                std::rethrow_exception(tile->second.failure);
+            }
+            if (tile != this->_tiles.end() and tile->second.done) {
+                triangles.insert(triangles.end(), tile->second.triangles.begin(), tile->second.triangles.end());
+            }
+        }
+        return triangles;
+    }
+
+    std::size_t TiledCanvas::tiles_grown() const {
+        std::lock_guard lock(this->_mutex);
+        return this->_tiles_grown;
+    }
+
+    std::vector<TiledCanvas::TileID> TiledCanvas::tiles_for(Point top_left, Vector size) const {
+        // triangles can poke out of their tile into its neighbours, so look one tile further out
+        TileID first = this->tile_at(top_left);
+        TileID last = this->tile_at(top_left + size);
+        std::vector<TileID> tiles;
+        for (std::int64_t y = first.y - 1; y <= last.y + 1; y++) {
+            for (std::int64_t x = first.x - 1; x <= last.x + 1; x++) {
+                tiles.push_back({x, y});
+            }
+        }
+        return tiles;
+    }
+
+    PRIVATE::Tiling TiledCanvas::tiling() const {
+        return {
+            this->_origin, this->_size, this->_rotation, this->_branch_edge,
+            this->_branch_point, this->_branch_angle, this->_tile_size, this->_tile_limit,
+        };
+    }
+
+    void TiledCanvas::schedule(TileID id) {
+        if (this->_tiles.contains(id)) {
+            return;
+        }
+        // find every tile not yet scheduled which this one transitively depends on
+        std::vector<TileID> unscheduled = {id};
+        std::set<TileID> seen = {id};
+        for (std::size_t i = 0; i < unscheduled.size(); i++) {
+            for (TileID dependency : PRIVATE::dependencies_of(unscheduled[i])) {
+                if (not this->_tiles.contains(dependency) and seen.insert(dependency).second) {
+                    unscheduled.push_back(dependency);
+                }
+            }
+        }
+        // dependencies always come earlier in growth order, so schedule in that order
+        std::sort(
+            unscheduled.begin(), unscheduled.end(),
+            [](TileID a, TileID b) { return growth_order(a) < growth_order(b); }
+        );
+        for (TileID tile_id : unscheduled) {
+            Tile& tile = this->_tiles[tile_id];
+            tile.dependencies = PRIVATE::dependencies_of(tile_id);
+            for (TileID dependency : tile.dependencies) {
+                Tile& other = this->_tiles.at(dependency);
+                if (not other.done) {
+                    other.dependents.push_back(tile_id);
+                    tile.waiting_on++;
+                }
+            }
+            if (tile.waiting_on == 0) {
+                this->_queue.push_back(tile_id);
+            }
+        }
+    }
+
+    std::vector<TriangleShape> TiledCanvas::grow(TileID id, const std::vector<const Tile*>& dependencies) const {
+        std::vector<TriangleShape> seeds;
+        for (const Tile* dependency : dependencies) {
+            seeds.insert(seeds.end(), dependency->triangles.begin(), dependency->triangles.end());
+        }
+        return this->tiling().grow(id, seeds);
+    }
+
+    void TiledCanvas::work() {
+        std::unique_lock lock(this->_mutex);
+        while (true) {
+            this->_work_available.wait(lock, [&] { return this->_stopping or not this->_queue.empty(); });
+            if (this->_stopping) {
+                return;
+            }
+            TileID id = this->_queue.front();
+            this->_queue.pop_front();
+            std::vector<TriangleShape> triangles;
+            std::exception_ptr failure;
+            try {
+                // finished tiles never change again, so can be read from without the lock
+                std::vector<const Tile*> dependencies;
+                for (TileID dependency : this->_tiles.at(id).dependencies) {
+                    const Tile& other = this->_tiles.at(dependency);
+                    // a tile can't be grown without all of its dependencies, so fails along with them
+                    if (other.failure) {
+                        failure = other.failure;
+                    }
+                    dependencies.push_back(&other);
+                }
+                if (not failure) {
+                    lock.unlock();
+                    triangles = this->grow(id, dependencies);
+                }
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            if (not lock.owns_lock()) {
+                lock.lock();
+            }
+            Tile& tile = this->_tiles.at(id);
+            tile.triangles = std::move(triangles);
+            tile.failure = failure;
+            tile.done = true;
+            if (not failure) {
+                this->_tiles_grown++;
+            }
+            // release any tiles that were only waiting for this one
+            for (TileID dependent : tile.dependents) {
+                if (--this->_tiles.at(dependent).waiting_on == 0) {
+                    this->_queue.push_back(dependent);
+                    this->_work_available.notify_one();
+                }
+            }
+            tile.dependents.clear();
+            this->_tile_done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/geometry.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleSink.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+#include "raster.hpp"
+
+namespace {
+    template <typename T>
+    void put(std::ostream& stream, T value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool get(std::istream& stream, T& value) {
+        return (bool)stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+}
+
+namespace com::saxbophone::triangberg {
+    BinarySink::BinarySink(const std::filesystem::path& path)
+      : _file(path, std::ios::binary | std::ios::trunc)
+      {}
+
+    void BinarySink::write(const StreamedTile& tile) {
+        if (this->has_failed()) {
+            return;
+        }
+        put(this->_file, (std::int64_t)tile.id.x);
+        put(this->_file, (std::int64_t)tile.id.y);
+        put(this->_file, (std::uint64_t)tile.triangles.size());
+        for (const TriangleShape& triangle : tile.triangles) {
+            for (Point corner : triangle) {
+                put(this->_file, corner.x);
+                put(this->_file, corner.y);
+            }
+        }
+    }
+
+    void BinarySink::finish() {
+        this->_file.flush();
+    }
+
+    bool BinarySink::has_failed() const {
+        // NOTE: a stream stays failed once any write or flush to it has, so this covers every one of them
+        return not this->_file;
+    }
+
+    std::vector<TriangleShape> BinarySink::read(
+        const std::filesystem::path& path,
+        std::vector<TrianglePair>* intersecting
+    ) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::streamoff size = file ? (std::streamoff)file.tellg() : 0;
+        file.seekg(0);
+        std::vector<TriangleShape> triangles;
+        std::int64_t x, y;
+        std::uint64_t count;
+        // only whole tiles are kept, so reading stops at the first that's truncated or corrupt
+        bool whole = true;
+        while (whole and get(file, x) and get(file, y) and get(file, count)) {
+            // a count the rest of the file can't hold can't be trusted to allocate for, either
+            std::uint64_t remaining = (std::uint64_t)(size - (std::streamoff)file.tellg());
+            if (count > remaining / (6 * sizeof(Unit))) {
+                break;
+            }
+            std::size_t tile_start = triangles.size();
+            for (std::uint64_t t = 0; whole and t < count; t++) {
+                TriangleShape triangle;
+                for (Point& corner : triangle) {
+                    whole = whole and get(file, corner.x) and get(file, corner.y);
+                }
+                triangles.push_back(triangle);
+            }
+            if (not whole) {
+                triangles.resize(tile_start);
+            }
+        }
+        if (intersecting != nullptr) {
+            *intersecting = find_intersecting_triangles(triangles);
+        }
+        return triangles;
+    }
+
+    SvgSink::SvgSink(const std::filesystem::path& path, Point top_left, Vector size)
+      : _file(path, std::ios::trunc)
+      , _finished(false)
+      {
+        this->_file
+            << "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\""
+            << top_left.x << ' ' << top_left.y << ' ' << size.x << ' ' << size.y << "\">\n";
+    }
+
+    SvgSink::~SvgSink() {
+        if (not this->_finished) {
+            this->SvgSink::finish();
+        }
+    }
+
+    void SvgSink::write(const StreamedTile& tile) {
+        if (this->has_failed()) {
+            return;
+        }
+        this->_file << "<g id=\"tile_" << tile.id.x << '_' << tile.id.y << "\">\n";
+        for (const TriangleShape& triangle : tile.triangles) {
+            this->_file << "<polygon points=\"";
+            for (std::size_t c = 0; c < 3; c++) {
+                this->_file << (c == 0 ? "" : " ") << triangle[c].x << ',' << triangle[c].y;
+            }
+            this->_file << "\"/>\n";
+        }
+        this->_file << "</g>\n";
+    }
+
+    void SvgSink::finish() {
+        this->_file << "</svg>\n";
+        this->_file.flush();
+        this->_finished = true;
+    }
+
+    bool SvgSink::has_failed() const {
+        return not this->_file;
+    }
+
+    RasterTileSink::RasterTileSink(std::filesystem::path directory, Unit scale)
+      : _directory(std::move(directory))
+      , _scale(scale)
+      , _failed(false)
+      {}
+
+    void RasterTileSink::write(const StreamedTile& tile) {
+        std::size_t width = (std::size_t)std::ceil(tile.size.x * this->_scale);
+        std::size_t height = (std::size_t)std::ceil(tile.size.y * this->_scale);
+        this->_pixels.assign(width * height, 0);
+        // triangles from neighbouring tiles can poke into this one
+        for (const TriangleShape& triangle : tile.surroundings) {
+            PRIVATE::fill_triangle(this->_pixels, width, height, triangle, tile.corner, this->_scale);
+        }
+        std::string name = "tile_" + std::to_string(tile.id.x) + "_" + std::to_string(tile.id.y) + ".pgm";
+        std::ofstream file(this->_directory / name, std::ios::binary | std::ios::trunc);
+        file << "P5\n" << width << ' ' << height << "\n255\n";
+        file.write(reinterpret_cast<const char*>(this->_pixels.data()), (std::streamsize)this->_pixels.size());
+        file.flush();
+        if (not file) {
+            this->_failed = true;
+        }
+    }
+
+    bool RasterTileSink::has_failed() const {
+        return this->_failed;
+    }
+}
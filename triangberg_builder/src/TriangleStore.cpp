@@ -0,0 +1,174 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <memory_resource>
+#include <span>
+
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+
+namespace {
+    // which chunk holds the triangle at index, given the size of the first chunk
+    std::size_t chunk_of(std::size_t index, std::size_t first_chunk_size) {
+        // chunk k starts at first_chunk_size * (2^k - 1)
+        return static_cast<std::size_t>(std::bit_width(index / first_chunk_size + 1)) - 1;
+    }
+
+    std::size_t chunk_start(std::size_t chunk, std::size_t first_chunk_size) {
+        return first_chunk_size * ((std::size_t(1) << chunk) - 1);
+    }
+
+    // gives a chunk back to the memory resource it came from, once no store needs it any more
+    struct ChunkDeleter {
+        std::pmr::memory_resource* resource;
+        std::size_t size;
+
+        void operator()(com::saxbophone::triangberg::TriangleShape* chunk) const {
+            using com::saxbophone::triangberg::TriangleShape;
+            // TriangleShape is trivially destructible, so chunks only need deallocating
+            this->resource->deallocate(chunk, sizeof(TriangleShape) * this->size, alignof(TriangleShape));
+        }
+    };
+}
+
+namespace com::saxbophone::triangberg {
+    TriangleStore::Snapshot::Iterator::Iterator(const TriangleStore* store, std::size_t index)
+      : _store(store)
+      , _index(index)
+      {}
+
+    TriangleStore::Snapshot::Iterator::reference TriangleStore::Snapshot::Iterator::operator*() const {
+        return this->_store->at(this->_index);
+    }
+
+    TriangleStore::Snapshot::Iterator::pointer TriangleStore::Snapshot::Iterator::operator->() const {
+        return &this->_store->at(this->_index);
+    }
+
+    TriangleStore::Snapshot::Iterator& TriangleStore::Snapshot::Iterator::operator++() {
+        this->_index++;
+        return *this;
+    }
+
+    TriangleStore::Snapshot::Iterator TriangleStore::Snapshot::Iterator::operator++(int) {
+        Iterator old = *this;
+        this->_index++;
+        return old;
+    }
+
+    TriangleStore::Snapshot::Snapshot(const TriangleStore* store, std::size_t first, std::size_t size)
+      : _store(store)
+      , _first(first)
+      , _size(size)
+      {}
+
+    std::size_t TriangleStore::Snapshot::size() const {
+        return this->_size;
+    }
+
+    TriangleStore::Snapshot TriangleStore::Snapshot::since(std::size_t first) const {
+        first = std::min(first, this->_size);
+        return {this->_store, this->_first + first, this->_size - first};
+    }
+
+    bool TriangleStore::Snapshot::empty() const {
+        return this->_size == 0;
+    }
+
+    const TriangleShape& TriangleStore::Snapshot::operator[](std::size_t index) const {
+        return this->_store->at(this->_first + index);
+    }
+
+    TriangleStore::Snapshot::Iterator TriangleStore::Snapshot::begin() const {
+        return {this->_store, this->_first};
+    }
+
+    TriangleStore::Snapshot::Iterator TriangleStore::Snapshot::end() const {
+        return {this->_store, this->_first + this->_size};
+    }
+
+    TriangleStore::TriangleStore(std::pmr::memory_resource* resource)
+      : _resource(resource)
+      , _chunks{}
+      , _shared_chunk(MAX_CHUNKS)
+      , _size(0)
+      {}
+
+    TriangleStore::TriangleStore(const TriangleStore& base, std::pmr::memory_resource* resource)
+      : TriangleStore(resource)
+      {
+        std::size_t size = base.size();
+        if (size == 0) {
+            return;
+        }
+        std::size_t last = chunk_of(size - 1, FIRST_CHUNK_SIZE);
+        for (std::size_t c = 0; c <= last; c++) {
+            this->_chunks[c].store(base._chunks[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            this->_owners[c] = base._owners[c];
+        }
+        // base may carry on appending to the last chunk, so we can't as well
+        if (chunk_of(size, FIRST_CHUNK_SIZE) == last) {
+            this->_shared_chunk = last;
+        }
+        this->_size.store(size, std::memory_order_release);
+    }
+
+    TriangleStore::~TriangleStore() = default;
+
+    void TriangleStore::push_back(const TriangleShape& triangle) {
+        // only the writer ever modifies the size, so it can read it relaxed
+        std::size_t index = this->_size.load(std::memory_order_relaxed);
+        std::size_t chunk = chunk_of(index, FIRST_CHUNK_SIZE);
+        std::size_t start = chunk_start(chunk, FIRST_CHUNK_SIZE);
+        TriangleShape* storage = this->_chunks[chunk].load(std::memory_order_relaxed);
+        if (storage == nullptr or chunk == this->_shared_chunk) {
+            std::size_t size = FIRST_CHUNK_SIZE << chunk;
+            TriangleShape* fresh = static_cast<TriangleShape*>(
+                this->_resource->allocate(sizeof(TriangleShape) * size, alignof(TriangleShape))
+            );
+            if (storage != nullptr) {
+                // copy what we share of it, leaving the original to the store it was shared from
+                std::ranges::uninitialized_copy(
+                    std::span<const TriangleShape>(storage, index - start),
+                    std::span<TriangleShape>(fresh, index - start)
+                );
+                this->_copied_from = std::move(this->_owners[chunk]);
+                this->_shared_chunk = MAX_CHUNKS;
+            }
+            this->_owners[chunk] = std::shared_ptr<TriangleShape>(
+                fresh, ChunkDeleter{this->_resource, size}, std::pmr::polymorphic_allocator<>(this->_resource)
+            );
+            storage = fresh;
+            // readers who can already see some of this chunk may pick up the copy straight away
+            this->_chunks[chunk].store(storage, std::memory_order_release);
+        }
+        std::construct_at(&storage[index - start], triangle);
+        // publish the new triangle (and its chunk, if new) to readers
+        this->_size.store(index + 1, std::memory_order_release);
+    }
+
+    std::size_t TriangleStore::size() const {
+        return this->_size.load(std::memory_order_acquire);
+    }
+
+    TriangleStore::Snapshot TriangleStore::snapshot() const {
+        return {this, 0, this->size()};
+    }
+
+    const TriangleShape& TriangleStore::at(std::size_t index) const {
+        std::size_t chunk = chunk_of(index, FIRST_CHUNK_SIZE);
+        // the acquire-load of _size that made index visible also made this chunk visible, but a
+        // shared chunk may since have been swapped for a copy, whose contents this makes visible
+        const TriangleShape* storage = this->_chunks[chunk].load(std::memory_order_acquire);
+        return storage[index - chunk_start(chunk, FIRST_CHUNK_SIZE)];
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * This is a sample private compilation unit.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory_resource>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+#include "coverage.hpp"
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    CoverageGrid::CoverageGrid(const allocator_type& allocator)
+      : _cells(RESOLUTION * RESOLUTION, 0, allocator)
+      , _top_left{0, 0}
+      , _cell_size{0, 0}
+      , _enabled(false)
+      , _centres_covered(0)
+      {}
+
+    CoverageGrid::CoverageGrid(const CoverageGrid& other, const allocator_type& allocator)
+      : _cells(other._cells, allocator)
+      , _top_left(other._top_left)
+      , _cell_size(other._cell_size)
+      , _enabled(other._enabled)
+      , _centres_covered(other._centres_covered)
+      {}
+
+    void CoverageGrid::reset(Point top_left, Vector size) {
+        std::fill(this->_cells.begin(), this->_cells.end(), 0);
+        this->_top_left = top_left;
+        this->_cell_size = size * (1 / (Unit)RESOLUTION);
+        this->_enabled = size.x > 0 and size.y > 0;
+        this->_centres_covered = 0;
+    }
+
+    void CoverageGrid::add(const TriangleShape& triangle) {
+        if (not this->_enabled) {
+            return;
+        }
+        // work in cell coördinates from here on
+        Point corners[3];
+        for (std::size_t c = 0; c < 3; c++) {
+            corners[c] = {
+                (triangle[c].x - this->_top_left.x) / this->_cell_size.x,
+                (triangle[c].y - this->_top_left.y) / this->_cell_size.y,
+            };
+        }
+        auto edge = [](Point a, Point b, Unit x, Unit y) {
+            return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+        };
+        Unit area = edge(corners[0], corners[1], corners[2].x, corners[2].y);
+        if (area == 0) {
+            return;
+        }
+        // the smallest of the three edge functions, scaled so it's positive inside the triangle
+        auto inside = [&](Unit x, Unit y) {
+            return std::min({
+                edge(corners[0], corners[1], x, y) * area,
+                edge(corners[1], corners[2], x, y) * area,
+                edge(corners[2], corners[0], x, y) * area,
+            });
+        };
+        // only visit the cells in both the triangle's bounding box and the grid
+        auto clamp = [](Unit value) {
+            return (std::size_t)std::clamp(value, (Unit)0, (Unit)RESOLUTION);
+        };
+        std::size_t x0 = clamp(std::floor(std::min({corners[0].x, corners[1].x, corners[2].x})));
+        std::size_t x1 = clamp(std::ceil(std::max({corners[0].x, corners[1].x, corners[2].x})));
+        std::size_t y0 = clamp(std::floor(std::min({corners[0].y, corners[1].y, corners[2].y})));
+        std::size_t y1 = clamp(std::ceil(std::max({corners[0].y, corners[1].y, corners[2].y})));
+        for (std::size_t y = y0; y < y1; y++) {
+            for (std::size_t x = x0; x < x1; x++) {
+                std::uint8_t& cell = this->_cells[y * RESOLUTION + x];
+                Unit left = (Unit)x;
+                Unit top = (Unit)y;
+                // a triangle is convex, so the whole cell is inside it when all four corners are
+                // NOTE: strictly inside, so that rounding can't have it fill what a touching triangle could use
+                if (
+                    inside(left, top) > 0 and inside(left + 1, top) > 0 and
+                    inside(left, top + 1) > 0 and inside(left + 1, top + 1) > 0
+                ) {
+                    cell |= FILLED;
+                }
+                if (not (cell & CENTRE_COVERED) and inside(left + 0.5, top + 0.5) >= 0) {
+                    cell |= CENTRE_COVERED;
+                    this->_centres_covered++;
+                }
+            }
+        }
+    }
+
+    double CoverageGrid::coverage() const {
+        return (double)this->_centres_covered / (double)this->_cells.size();
+    }
+}
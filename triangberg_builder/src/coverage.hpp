@@ -0,0 +1,78 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_COVERAGE_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_COVERAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory_resource>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    /*
+     * Low-resolution occupancy bitmap of an area, which triangles are added to
+     * as they're placed
+     * Each cell remembers whether it lies wholly inside any one triangle, which
+     * makes for a conservative test of whether a point is already filled: it
+     * never says so when it isn't, but misses points near triangles' edges and
+     * in cells that are only filled by several triangles between them.
+     * Each cell also remembers whether its centre is inside any triangle, as an
+     * estimate of how much of the area is filled.
+     */
+    class CoverageGrid {
+    public:
+        typedef std::pmr::polymorphic_allocator<> allocator_type;
+
+        // how many cells the area is split into, along each side
+        static constexpr std::size_t RESOLUTION = 128;
+
+        explicit CoverageGrid(const allocator_type& allocator);
+
+        CoverageGrid(const CoverageGrid& other, const allocator_type& allocator);
+
+        // empties the grid and moves it to cover the given area
+        void reset(Point top_left, Vector size);
+
+        void add(const TriangleShape& triangle);
+
+        // whether the point is definitely inside one of the triangles added
+        bool is_filled(Point point) const {
+            if (not this->_enabled) {
+                return false;
+            }
+            Unit x = (point.x - this->_top_left.x) / this->_cell_size.x;
+            Unit y = (point.y - this->_top_left.y) / this->_cell_size.y;
+            // NOTE: written to be false for NaN too
+            if (not (x >= 0 and x < RESOLUTION and y >= 0 and y < RESOLUTION)) {
+                return false;
+            }
+            return this->_cells[(std::size_t)y * RESOLUTION + (std::size_t)x] & FILLED;
+        }
+
+        // fraction of the area's cells whose centres are inside a triangle
+        double coverage() const;
+
+    private:
+        // bits of each cell
+        static constexpr std::uint8_t FILLED = 1; // wholly inside a triangle
+        static constexpr std::uint8_t CENTRE_COVERED = 2;
+
+        std::pmr::vector<std::uint8_t> _cells; // row by row
+        Point _top_left;
+        Vector _cell_size;
+        bool _enabled; // only when the area isn't empty
+        std::size_t _centres_covered;
+    };
+}
+
+#endif // include guard
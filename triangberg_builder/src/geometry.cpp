@@ -9,12 +9,16 @@
 #include <cmath>
 #include <cstddef>
 
+#include <algorithm>
+#include <numeric>
+#include <span>
 #include <vector>
 
 #include <triangberg_builder/types.hpp>
 #include <triangberg_builder/geometry.hpp>
 #include <triangberg_builder/Line.hpp>
 #include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
 #include <triangberg_builder/Vector.hpp>
 
 // are_intersecting implementation
@@ -66,6 +70,43 @@ namespace {
     }
 }
 
+// are_intersecting implementation for triangles
+namespace {
+    using namespace com::saxbophone::triangberg;
+
+    // how far into each other triangles can reach before they count as overlapping, allowing for rounding error
+    const Unit OVERLAP_TOLERANCE = 1e-6;
+
+    // whether any edge of triangle a has all of triangle b on its outside (or along it)
+    bool has_separating_edge(const TriangleShape& a, const TriangleShape& b) {
+        // the sign of the area says which way round the corners go, so which side of each edge is inside
+        Unit area =
+            (a[1].x - a[0].x) * (a[2].y - a[0].y) -
+            (a[1].y - a[0].y) * (a[2].x - a[0].x);
+        Unit sign = area < 0 ? -1 : 1;
+        for (std::size_t i = 0; i < 3; i++) {
+            const Point& from = a[i];
+            const Point& to = a[(i + 1) % 3];
+            Unit edge_x = to.x - from.x;
+            Unit edge_y = to.y - from.y;
+            // sides are edge functions --distances from the edge scaled by its length, so are compared squared
+            Unit limit = OVERLAP_TOLERANCE * OVERLAP_TOLERANCE * (edge_x * edge_x + edge_y * edge_y);
+            bool separates = true;
+            for (const Point& corner : b) {
+                Unit side = sign * (edge_x * (corner.y - from.y) - edge_y * (corner.x - from.x));
+                if (side > 0 and side * side > limit) {
+                    separates = false;
+                    break;
+                }
+            }
+            if (separates) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
 namespace com::saxbophone::triangberg {
     Radians degrees_to_radians(Degrees d) {
         return d * (M_PI / 180.0);
@@ -90,6 +131,24 @@ namespace com::saxbophone::triangberg {
         return origin + v;
     }
 
+    void subtend_points_from_vectors(
+        std::span<const Unit> origin_x,
+        std::span<const Unit> origin_y,
+        std::span<const Unit> v_x,
+        std::span<const Unit> v_y,
+        Radians theta,
+        std::span<Unit> out_x,
+        std::span<Unit> out_y
+    ) {
+        Unit cos_theta = std::cos(theta);
+        Unit sin_theta = std::sin(theta);
+        // same sums as rotate_point() followed by adding the origin, so gives the same results
+        for (std::size_t i = 0; i < out_x.size(); i++) {
+            out_x[i] = origin_x[i] + (v_x[i] * cos_theta - v_y[i] * sin_theta);
+            out_y[i] = origin_y[i] + (v_x[i] * sin_theta + v_y[i] * cos_theta);
+        }
+    }
+
     bool are_intersecting(Line a, Line b) {
         // test both if a intersects b and b intersects a
         // --this is needed because only comparing from one POV gets false positives
@@ -97,6 +156,69 @@ namespace com::saxbophone::triangberg {
         return lines_intersect(a, b) and lines_intersect(b, a);
     }
 
+    bool are_intersecting(const TriangleShape& a, const TriangleShape& b) {
+        // triangles whose bounding boxes are apart (or only touch) can't overlap
+        if (
+            std::max({a[0].x, a[1].x, a[2].x}) <= std::min({b[0].x, b[1].x, b[2].x}) + OVERLAP_TOLERANCE or
+            std::max({b[0].x, b[1].x, b[2].x}) <= std::min({a[0].x, a[1].x, a[2].x}) + OVERLAP_TOLERANCE or
+            std::max({a[0].y, a[1].y, a[2].y}) <= std::min({b[0].y, b[1].y, b[2].y}) + OVERLAP_TOLERANCE or
+            std::max({b[0].y, b[1].y, b[2].y}) <= std::min({a[0].y, a[1].y, a[2].y}) + OVERLAP_TOLERANCE
+        ) {
+            return false;
+        }
+        // two triangles' insides are apart exactly when one of their six edges separates them
+        return not has_separating_edge(a, b) and not has_separating_edge(b, a);
+    }
+
+    std::vector<TrianglePair> find_intersecting_triangles(std::span<const TriangleShape> triangles) {
+        struct Extent {
+            Unit min_x;
+            Unit min_y;
+            Unit max_x;
+            Unit max_y;
+        };
+        std::vector<Extent> extents;
+        extents.reserve(triangles.size());
+        for (const TriangleShape& t : triangles) {
+            extents.push_back({
+                std::min({t[0].x, t[1].x, t[2].x}),
+                std::min({t[0].y, t[1].y, t[2].y}),
+                std::max({t[0].x, t[1].x, t[2].x}),
+                std::max({t[0].y, t[1].y, t[2].y}),
+            });
+        }
+        std::vector<std::size_t> order(triangles.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(
+            order.begin(), order.end(),
+            [&](std::size_t a, std::size_t b) { return extents[a].min_x < extents[b].min_x; }
+        );
+        std::vector<TrianglePair> pairs;
+        // triangles the sweep has reached but not yet passed the right of
+        std::vector<std::size_t> active;
+        for (std::size_t next : order) {
+            const Extent& extent = extents[next];
+            // NOTE: a little generous, so that rounding can't make this disagree with the edge tests
+            std::erase_if(active, [&](std::size_t a) { return extents[a].max_x + OVERLAP_TOLERANCE < extent.min_x; });
+            for (std::size_t a : active) {
+                if (
+                    extents[a].min_y <= extent.max_y + OVERLAP_TOLERANCE and extent.min_y <= extents[a].max_y + OVERLAP_TOLERANCE and
+                    are_intersecting(triangles[a], triangles[next])
+                ) {
+                    pairs.push_back({std::min(a, next), std::max(a, next)});
+                }
+            }
+            active.push_back(next);
+        }
+        std::sort(
+            pairs.begin(), pairs.end(),
+            [](const TrianglePair& a, const TrianglePair& b) {
+                return a.first < b.first or (a.first == b.first and a.second < b.second);
+            }
+        );
+        return pairs;
+    }
+
     bool is_concave(std::vector<Point> points) {
         bool sign = false;
         for (std::size_t i = 0; i < points.size(); i++) {
@@ -0,0 +1,70 @@
+/*
+ * This is a sample private compilation unit.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    std::size_t thread_count(std::size_t requested) {
+        if (requested == 0) {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+        return requested;
+    }
+
+    void run_on_threads(std::size_t threads, const std::function<void(std::size_t)>& work) {
+        std::mutex mutex;
+        std::exception_ptr failure;
+        // an exception escaping a thread would terminate the program, so it's kept for the caller instead
+        auto guarded = [&](std::size_t worker) {
+            try {
+                work(worker);
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (not failure) {
+                    failure = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < threads; t++) {
+            workers.emplace_back(guarded, t);
+        }
+        guarded(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    void parallel_for(std::size_t count, std::size_t threads, const std::function<void(std::size_t)>& task) {
+        std::atomic<std::size_t> next = 0;
+        run_on_threads(
+            std::max((std::size_t)1, std::min(thread_count(threads), count)),
+            [&](std::size_t) {
+                try {
+                    for (std::size_t i = next++; i < count; i = next++) {
+                        task(i);
+                    }
+                } catch (...) {
+                    next = count; // no point anyone else starting any more
+                    throw;
+                }
+            }
+        );
+    }
+}
@@ -0,0 +1,31 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_PARALLEL_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_PARALLEL_HPP
+
+#include <cstddef>
+
+#include <functional>
+
+// sharing work out between threads, the same way everywhere in the library
+namespace com::saxbophone::triangberg::PRIVATE {
+    // how many threads to use when asked for the given number, 0 meaning one per hardware thread
+    std::size_t thread_count(std::size_t requested);
+
+    // calls work(worker) for each worker in 0..threads-1 at once, worker 0 on the calling thread, and waits for them
+    // all to return
+    // NOTE: if any of them throw, the first exception is rethrown here once the rest have returned, so those still
+    // running must be told to give up by whichever threw, if they might otherwise wait on it forever
+    void run_on_threads(std::size_t threads, const std::function<void(std::size_t)>& work);
+
+    // calls task(i) for each i in 0..count-1 on up to threads threads (0 meaning one per hardware thread), each
+    // taking the next i as it becomes free, and waits for them all
+    // NOTE: if any task throws, no more are started and the first exception is rethrown here
+    void parallel_for(std::size_t count, std::size_t threads, const std::function<void(std::size_t)>& task);
+}
+
+#endif // include guard
@@ -0,0 +1,119 @@
+/*
+ * This is a sample private compilation unit.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+
+#include "raster.hpp"
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    void fill_triangle(
+        std::span<std::uint8_t> pixels,
+        std::size_t width,
+        std::size_t height,
+        const TriangleShape& triangle,
+        Point top_left,
+        Unit scale
+    ) {
+        // work in pixel coördinates from here on
+        Point corners[3];
+        for (std::size_t c = 0; c < 3; c++) {
+            corners[c] = {(triangle[c].x - top_left.x) * scale, (triangle[c].y - top_left.y) * scale};
+        }
+        auto edge = [](Point a, Point b, Unit x, Unit y) {
+            return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+        };
+        Unit area = edge(corners[0], corners[1], corners[2].x, corners[2].y);
+        if (area == 0) {
+            return;
+        }
+        Unit left = std::min({corners[0].x, corners[1].x, corners[2].x});
+        Unit right = std::max({corners[0].x, corners[1].x, corners[2].x});
+        Unit top = std::min({corners[0].y, corners[1].y, corners[2].y});
+        Unit bottom = std::max({corners[0].y, corners[1].y, corners[2].y});
+        // only visit the pixels in both the triangle's bounding box and the image
+        std::int64_t x0 = std::max<std::int64_t>(0, (std::int64_t)std::floor(left));
+        std::int64_t x1 = std::min<std::int64_t>((std::int64_t)width, (std::int64_t)std::ceil(right));
+        std::int64_t y0 = std::max<std::int64_t>(0, (std::int64_t)std::floor(top));
+        std::int64_t y1 = std::min<std::int64_t>((std::int64_t)height, (std::int64_t)std::ceil(bottom));
+        for (std::int64_t y = y0; y < y1; y++) {
+            for (std::int64_t x = x0; x < x1; x++) {
+                Unit cx = (Unit)x + 0.5;
+                Unit cy = (Unit)y + 0.5;
+                // inside when on the same side of all three edges as the triangle itself
+                Unit e0 = edge(corners[0], corners[1], cx, cy) * area;
+                Unit e1 = edge(corners[1], corners[2], cx, cy) * area;
+                Unit e2 = edge(corners[2], corners[0], cx, cy) * area;
+                if (e0 >= 0 and e1 >= 0 and e2 >= 0) {
+                    pixels[(std::size_t)y * width + (std::size_t)x] = 255;
+                }
+            }
+        }
+    }
+
+    void shade_triangle(
+        std::span<std::uint8_t> pixels,
+        std::size_t width,
+        std::size_t height,
+        const TriangleShape& triangle,
+        const std::array<Rgb, 3>& colours,
+        Point top_left,
+        Unit scale
+    ) {
+        // work in pixel coördinates from here on
+        Point corners[3];
+        for (std::size_t c = 0; c < 3; c++) {
+            corners[c] = {(triangle[c].x - top_left.x) * scale, (triangle[c].y - top_left.y) * scale};
+        }
+        auto edge = [](Point a, Point b, Unit x, Unit y) {
+            return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+        };
+        Unit area = edge(corners[0], corners[1], corners[2].x, corners[2].y);
+        if (area == 0) {
+            return;
+        }
+        Unit left = std::min({corners[0].x, corners[1].x, corners[2].x});
+        Unit right = std::max({corners[0].x, corners[1].x, corners[2].x});
+        Unit top = std::min({corners[0].y, corners[1].y, corners[2].y});
+        Unit bottom = std::max({corners[0].y, corners[1].y, corners[2].y});
+        std::int64_t x0 = std::max<std::int64_t>(0, (std::int64_t)std::floor(left));
+        std::int64_t x1 = std::min<std::int64_t>((std::int64_t)width, (std::int64_t)std::ceil(right));
+        std::int64_t y0 = std::max<std::int64_t>(0, (std::int64_t)std::floor(top));
+        std::int64_t y1 = std::min<std::int64_t>((std::int64_t)height, (std::int64_t)std::ceil(bottom));
+        for (std::int64_t y = y0; y < y1; y++) {
+            for (std::int64_t x = x0; x < x1; x++) {
+                Unit cx = (Unit)x + 0.5;
+                Unit cy = (Unit)y + 0.5;
+                // the edge opposite each corner, as a fraction of the whole, is how much of its colour to use
+                Unit weights[3] = {
+                    edge(corners[1], corners[2], cx, cy) / area,
+                    edge(corners[2], corners[0], cx, cy) / area,
+                    edge(corners[0], corners[1], cx, cy) / area,
+                };
+                if (weights[0] < 0 or weights[1] < 0 or weights[2] < 0) {
+                    continue;
+                }
+                std::uint8_t* pixel = &pixels[((std::size_t)y * width + (std::size_t)x) * 3];
+                for (std::size_t channel = 0; channel < 3; channel++) {
+                    Unit value = 0;
+                    for (std::size_t c = 0; c < 3; c++) {
+                        value += weights[c] * colours[c][channel];
+                    }
+                    pixel[channel] = (std::uint8_t)std::clamp(std::lround(value), 0l, 255l);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_RASTER_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_RASTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <span>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    /*
+     * sets every pixel whose centre is inside the triangle to 255, in an 8-bit
+     * image of the given size whose top-left pixel is at top_left, with scale
+     * pixels per unit
+     */
+    void fill_triangle(
+        std::span<std::uint8_t> pixels,
+        std::size_t width,
+        std::size_t height,
+        const TriangleShape& triangle,
+        Point top_left = {0, 0},
+        Unit scale = 1
+    );
+
+    // an 8-bit-per-channel colour
+    typedef std::array<std::uint8_t, 3> Rgb;
+
+    /*
+     * like fill_triangle(), but in an RGB image (3 bytes per pixel), with each
+     * pixel's colour blended between those of the triangle's corners by how
+     * close it is to each
+     */
+    void shade_triangle(
+        std::span<std::uint8_t> pixels,
+        std::size_t width,
+        std::size_t height,
+        const TriangleShape& triangle,
+        const std::array<Rgb, 3>& colours,
+        Point top_left = {0, 0},
+        Unit scale = 1
+    );
+}
+
+#endif // include guard
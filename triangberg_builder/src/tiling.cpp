@@ -0,0 +1,110 @@
+/*
+ * This is a sample private compilation unit.
+ *
+ * <Copyright information goes here>
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Drawing.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/TriangleStore.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+#include "tiling.hpp"
+
+namespace com::saxbophone::triangberg::PRIVATE {
+    std::int64_t ring_of(TileID id) {
+        return std::max(id.x < 0 ? -id.x : id.x, id.y < 0 ? -id.y : id.y);
+    }
+
+    std::tuple<std::int64_t, std::int64_t, std::int64_t> growth_order(TileID id) {
+        return std::make_tuple(ring_of(id), id.x, id.y);
+    }
+
+    std::vector<TileID> neighbours_of(TileID id) {
+        std::vector<TileID> neighbours;
+        for (std::int64_t dy = -1; dy <= 1; dy++) {
+            for (std::int64_t dx = -1; dx <= 1; dx++) {
+                if (dx != 0 or dy != 0) {
+                    neighbours.push_back({id.x + dx, id.y + dy});
+                }
+            }
+        }
+        return neighbours;
+    }
+
+    std::vector<TileID> dependencies_of(TileID id) {
+        std::vector<TileID> dependencies;
+        for (TileID neighbour : neighbours_of(id)) {
+            if (growth_order(neighbour) < growth_order(id)) {
+                dependencies.push_back(neighbour);
+            }
+        }
+        return dependencies;
+    }
+
+    Point Tiling::grid_origin() const {
+        return this->origin - this->tile_size * 0.5;
+    }
+
+    Point Tiling::corner_of(TileID id) const {
+        Point grid_origin = this->grid_origin();
+        return {
+            grid_origin.x + (Unit)id.x * this->tile_size.x,
+            grid_origin.y + (Unit)id.y * this->tile_size.y,
+        };
+    }
+
+    TileID Tiling::tile_at(Point point) const {
+        Vector offset = point - this->grid_origin();
+        return {
+            (std::int64_t)std::floor(offset.x / this->tile_size.x),
+            (std::int64_t)std::floor(offset.y / this->tile_size.y),
+        };
+    }
+
+    Unit Tiling::reach() const {
+        return std::min(this->tile_size.x, this->tile_size.y) / 2;
+    }
+
+    std::vector<TriangleShape> Tiling::grow(TileID id, std::span<const TriangleShape> seeds) const {
+        Point corner = this->corner_of(id);
+        if (id == TileID{0, 0}) {
+            // the origin tile is just an ordinary Drawing, confined to this tile
+            Drawing drawing(
+                this->origin, this->size, this->rotation, this->branch_edge,
+                this->branch_point, this->branch_angle, this->tile_size
+            );
+            drawing.set_bounds(corner, this->tile_size);
+            drawing.set_edge_length_bounds(0, this->reach());
+            drawing.add_triangles(this->tile_limit);
+            TriangleStore::Snapshot snapshot = drawing.snapshot();
+            return {snapshot.begin(), snapshot.end()};
+        }
+        // every other tile carries on from wherever its neighbours left off
+        if (seeds.empty()) {
+            return {}; // nothing has grown anywhere near this tile
+        }
+        Drawing drawing(seeds, this->tile_size);
+        drawing.set_bounds(corner, this->tile_size);
+        drawing.set_edge_length_bounds(0, this->reach());
+        drawing.add_triangles(this->tile_limit);
+        TriangleStore::Snapshot snapshot = drawing.snapshot();
+        std::vector<TriangleShape> triangles;
+        // the seeds belong to the neighbours, only keep what was grown here
+        for (std::size_t i = seeds.size(); i < snapshot.size(); i++) {
+            triangles.push_back(snapshot[i]);
+        }
+        return triangles;
+    }
+}
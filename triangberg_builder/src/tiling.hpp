@@ -0,0 +1,65 @@
+/*
+ * This is a private header for use by the library's own compilation units.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifndef COM_SAXBOPHONE_TRIANGBERG_TILING_HPP
+#define COM_SAXBOPHONE_TRIANGBERG_TILING_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <triangberg_builder/types.hpp>
+#include <triangberg_builder/Point.hpp>
+#include <triangberg_builder/TiledCanvas.hpp>
+#include <triangberg_builder/TriangleShape.hpp>
+#include <triangberg_builder/Vector.hpp>
+
+// rules for growing a drawing tile by tile, shared by everything that does so
+namespace com::saxbophone::triangberg::PRIVATE {
+    typedef TiledCanvas::TileID TileID;
+
+    // how many rings out from the origin tile the given tile is
+    std::int64_t ring_of(TileID id);
+
+    // tiles are grown in this order: ring by ring outwards from the origin tile
+    std::tuple<std::int64_t, std::int64_t, std::int64_t> growth_order(TileID id);
+
+    // all eight tiles around the given one
+    std::vector<TileID> neighbours_of(TileID id);
+
+    // the tiles neighbouring this one which are grown before it
+    std::vector<TileID> dependencies_of(TileID id);
+
+    // everything needed to grow any tile of a tiled drawing
+    struct Tiling {
+        Point origin;
+        Unit size;
+        Degrees rotation;
+        EdgeID branch_edge;
+        Percentage branch_point;
+        Degrees branch_angle;
+        Vector tile_size;
+        std::size_t tile_limit;
+
+        // top-left corner of tile {0, 0}, which is centred on the origin
+        Point grid_origin() const;
+
+        Point corner_of(TileID id) const;
+
+        TileID tile_at(Point point) const;
+
+        // longest edge a grown triangle may have: half a tile, so it can't reach past the neighbouring tiles
+        Unit reach() const;
+
+        // grows the given tile from the triangles of all its dependencies, returning only the new ones
+        std::vector<TriangleShape> grow(TileID id, std::span<const TriangleShape> seeds) const;
+    };
+}
+
+#endif // include guard
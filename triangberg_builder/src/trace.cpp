@@ -0,0 +1,94 @@
+/*
+ * This is a sample source file corresponding to a public header file.
+ *
+ * <Copyright information goes here>
+ */
+
+#ifdef TRIANGBERG_TRACING
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <triangberg_builder/trace.hpp>
+
+namespace {
+    struct Event {
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::duration duration;
+    };
+
+    // only ever written to by the thread it belongs to
+    struct ThreadBuffer {
+        std::size_t thread_id;
+        std::vector<Event> events;
+    };
+
+    // owns every thread's buffer, so they survive their threads, and writes them all out at exit
+    class Registry {
+    public:
+        ~Registry() {
+            const char* path = std::getenv("TRIANGBERG_TRACE_FILE");
+            std::ofstream file(path != nullptr ? path : "triangberg-trace.json");
+            file << "{\"traceEvents\":[";
+            bool first = true;
+            for (const auto& buffer : this->_buffers) {
+                for (const Event& event : buffer->events) {
+                    auto start = std::chrono::duration_cast<std::chrono::nanoseconds>(event.start - this->_epoch);
+                    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(event.duration);
+                    file << (first ? "\n" : ",\n");
+                    // timestamps are in microseconds, but fractions are allowed
+                    file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                         << buffer->thread_id << ",\"ts\":" << (double)start.count() / 1000.0
+                         << ",\"dur\":" << (double)duration.count() / 1000.0 << "}";
+                    first = false;
+                }
+            }
+            file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+        // called once per thread, the first time it records a zone
+        ThreadBuffer* new_buffer() {
+            std::lock_guard lock(this->_mutex);
+            this->_buffers.push_back(std::make_unique<ThreadBuffer>());
+            this->_buffers.back()->thread_id = this->_buffers.size();
+            return this->_buffers.back().get();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+        std::mutex _mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+    };
+
+    Registry& registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadBuffer& this_thread_buffer() {
+        thread_local ThreadBuffer* buffer = registry().new_buffer();
+        return *buffer;
+    }
+}
+
+namespace com::saxbophone::triangberg::trace {
+    Zone::Zone(const char* name) : _name(name) {
+        // make sure the buffer exists before timing starts, so that isn't counted
+        this_thread_buffer();
+        this->_start = std::chrono::steady_clock::now();
+    }
+
+    Zone::~Zone() {
+        auto end = std::chrono::steady_clock::now();
+        this_thread_buffer().events.push_back({this->_name, this->_start, end - this->_start});
+    }
+}
+
+#endif